@@ -16,10 +16,22 @@ extern "C"
 
 #define MTSP_VRP_C_RESULT_SOLVED 0
 #define MTSP_VRP_C_RESULT_TIMEOUT 1
+#define MTSP_VRP_C_RESULT_HEURISTIC 2
+#define MTSP_VRP_C_RESULT_BOUND 3
 
 #define MTSP_VRP_C_OPTIMIZATION_MODE_SUM 0
 #define MTSP_VRP_C_OPTIMIZATION_MODE_MAX 1
 
+#define MTSP_VRP_C_SOLVE_MODE_BRANCH_AND_CUT 0
+#define MTSP_VRP_C_SOLVE_MODE_HEURISTIC 1
+#define MTSP_VRP_C_SOLVE_MODE_BOUND 2
+#define MTSP_VRP_C_SOLVE_MODE_DECOMPOSITION 3
+
+#define MTSP_VRP_C_DISTANCE_FUNCTION_EUC_2D 0
+#define MTSP_VRP_C_DISTANCE_FUNCTION_CEIL_2D 1
+#define MTSP_VRP_C_DISTANCE_FUNCTION_ATT 2
+#define MTSP_VRP_C_DISTANCE_FUNCTION_GEO 3
+
 #define MTSP_VRP_C_NO_RESULT_TIMEOUT -1
 #define MTSP_VRP_C_NO_RESULT_INFEASIBLE -2
 #define MTSP_VRP_C_NO_RESULT_INVALID_INPUT_SIZE -3
@@ -27,13 +39,45 @@ extern "C"
 #define MTSP_VRP_C_CYCLIC_DEPENDENCIES -5
 #define MTSP_VRP_C_INCOMPATIBLE_DEPENDENCIES -6
 #define MTSP_VRP_C_INVALID_OPTIMIZATION_MODE -7
+#define MTSP_VRP_C_INVALID_DISTANCE_FUNCTION -8
+#define MTSP_VRP_C_INVALID_SOLVE_MODE -9
 
+    // The fractional callback receives the LP values of the arcs from u to v of agent a at index
+    // (a * numberOfNodes + u) * numberOfNodes + v. For a single agent on symmetric weights without
+    // dependencies, the LP is undirected and both arcs of an edge get half of its value.
     MTSP_VRP_C_EXPORT int solve_mtsp_vrp(
         size_t numberOfAgents, size_t numberOfNodes, const size_t* start_positions,
         const size_t* end_positions, const int* weights, int optimizationMode, int timeout_ms,
         size_t numberOfThreads, double* lowerBound, double* upperBound, size_t* paths,
         size_t* pathOffsets, int (*fractional_callback)(const double*));
 
+    // Like solve_mtsp_vrp, which uses MTSP_VRP_C_SOLVE_MODE_BRANCH_AND_CUT. With
+    // MTSP_VRP_C_SOLVE_MODE_HEURISTIC, no LP is created, which for large instances can take longer
+    // than the timeout. Instead, the whole time is spent on improvement heuristics, and the lower
+    // bound is only a cheap one. Unless the bounds meet, the result is then
+    // MTSP_VRP_C_RESULT_HEURISTIC. With MTSP_VRP_C_SOLVE_MODE_BOUND, only the cutting planes of the
+    // root are added and the fractional callback is called once with the final LP solution. Unless
+    // the bounds meet, the result is then MTSP_VRP_C_RESULT_BOUND, and the paths are only written
+    // if the upper bound is finite. MTSP_VRP_C_SOLVE_MODE_DECOMPOSITION clusters the nodes to the
+    // agents and solves the path of each cluster separately, for many agents and nodes. Like
+    // MTSP_VRP_C_SOLVE_MODE_HEURISTIC, it only provides a cheap lower bound.
+    MTSP_VRP_C_EXPORT int solve_mtsp_vrp_with_mode(
+        size_t numberOfAgents, size_t numberOfNodes, const size_t* start_positions,
+        const size_t* end_positions, const int* weights, int optimizationMode, int solveMode,
+        int timeout_ms, size_t numberOfThreads, double* lowerBound, double* upperBound,
+        size_t* paths, size_t* pathOffsets, int (*fractional_callback)(const double*));
+
+    // For nodes given by coordinates, with TSPLIB distances that are computed on demand, so no
+    // weight matrix is needed. Solved heuristically without an LP, so the result is
+    // MTSP_VRP_C_RESULT_HEURISTIC and the lower bound is 0. Single tours of at least 10000 nodes
+    // are solved by a multilevel scheme. Start or end positions that are not less than
+    // numberOfNodes give MTSP_VRP_C_NO_RESULT_INVALID_INPUT_SIZE.
+    MTSP_VRP_C_EXPORT int solve_mtsp_vrp_coordinates(
+        size_t numberOfAgents, size_t numberOfNodes, const size_t* start_positions,
+        const size_t* end_positions, const double* x, const double* y, int distanceFunction,
+        int optimizationMode, int timeout_ms, size_t numberOfThreads, double* lowerBound,
+        double* upperBound, size_t* paths, size_t* pathOffsets);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,7 @@
 #include "mtsp-vrp-c.h"
 
+#include <CoordinateWeights.hpp>
+#include <Heuristics.hpp>
 #include <MtspModel.hpp>
 #include <TsplpExceptions.hpp>
 
@@ -8,12 +10,47 @@
 #include <array>
 #include <chrono>
 #include <functional>
+#include <span>
+#include <thread>
+
+namespace
+{
+template <typename Positions>
+void CopyPaths(
+    const std::vector<std::vector<size_t>>& resultPaths, const Positions& startPositions,
+    const Positions& endPositions, size_t* paths, size_t* pathOffsets)
+{
+    size_t offset = 0;
+    for (size_t a = 0; a < resultPaths.size(); ++a)
+    {
+        pathOffsets[a] = offset; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        auto length = resultPaths[a].size();
+        if (startPositions[a] == endPositions[a])
+            --length; // don't copy unneeded (duplicate) last entry
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::copy_n(resultPaths[a].begin(), length, paths + offset);
+        offset += length;
+    }
+}
+}
 
 int solve_mtsp_vrp(
     size_t numberOfAgents, size_t numberOfNodes, const size_t* start_positions,
     const size_t* end_positions, const int* weights, int optimizationMode, int timeout_ms,
     size_t numberOfThreads, double* lowerBound, double* upperBound, size_t* paths,
     size_t* pathOffsets, int (*fractional_callback)(const double*))
+{
+    return solve_mtsp_vrp_with_mode(
+        numberOfAgents, numberOfNodes, start_positions, end_positions, weights, optimizationMode,
+        MTSP_VRP_C_SOLVE_MODE_BRANCH_AND_CUT, timeout_ms, numberOfThreads, lowerBound, upperBound,
+        paths, pathOffsets, fractional_callback);
+}
+
+int solve_mtsp_vrp_with_mode(
+    size_t numberOfAgents, size_t numberOfNodes, const size_t* start_positions,
+    const size_t* end_positions, const int* weights, int optimizationMode, int solveMode,
+    int timeout_ms, size_t numberOfThreads, double* lowerBound, double* upperBound, size_t* paths,
+    size_t* pathOffsets, int (*fractional_callback)(const double*))
 {
     const auto startTime = std::chrono::steady_clock::now();
 
@@ -29,6 +66,11 @@ int solve_mtsp_vrp(
         && optimizationMode != MTSP_VRP_C_OPTIMIZATION_MODE_MAX)
         return MTSP_VRP_C_INVALID_OPTIMIZATION_MODE;
 
+    if (solveMode != MTSP_VRP_C_SOLVE_MODE_BRANCH_AND_CUT
+        && solveMode != MTSP_VRP_C_SOLVE_MODE_HEURISTIC && solveMode != MTSP_VRP_C_SOLVE_MODE_BOUND
+        && solveMode != MTSP_VRP_C_SOLVE_MODE_DECOMPOSITION)
+        return MTSP_VRP_C_INVALID_SOLVE_MODE;
+
     const std::array positionsShape = { numberOfAgents };
     const auto startPositions
         = xt::adapt(start_positions, numberOfAgents, xt::no_ownership {}, positionsShape);
@@ -61,34 +103,48 @@ int solve_mtsp_vrp(
                 assert(tensor.shape() == (std::array{numberOfAgents, numberOfNodes, numberOfNodes}));
                 fractional_callback(tensor.data()); }
             : std::function<void(const xt::xtensor<double, 3>&)> {};
-        model.BranchAndCutSolve(numberOfThreads, callback);
+
+        if (solveMode == MTSP_VRP_C_SOLVE_MODE_HEURISTIC)
+            model.HeuristicSolve(numberOfThreads);
+        else if (solveMode == MTSP_VRP_C_SOLVE_MODE_BOUND)
+            model.BoundSolve(numberOfThreads, callback);
+        else if (solveMode == MTSP_VRP_C_SOLVE_MODE_DECOMPOSITION)
+            model.DecompositionSolve(numberOfThreads);
+        else
+            model.BranchAndCutSolve(numberOfThreads, callback);
 
         const auto& result = model.GetResult();
         const auto [lb, ub] = result.GetBounds();
         *lowerBound = lb;
         *upperBound = ub;
 
+        // the bound is the result, even without paths
+        if (solveMode == MTSP_VRP_C_SOLVE_MODE_BOUND && lb < ub)
+        {
+            if (lb == -std::numeric_limits<double>::max())
+                return MTSP_VRP_C_NO_RESULT_TIMEOUT;
+
+            if (ub < std::numeric_limits<double>::max())
+                CopyPaths(result.GetPaths(), startPositions, endPositions, paths, pathOffsets);
+
+            return MTSP_VRP_C_RESULT_BOUND;
+        }
+
         if (!result.IsTimeoutHit() && ub == std::numeric_limits<double>::max())
             return MTSP_VRP_C_NO_RESULT_INFEASIBLE;
 
         if (result.IsTimeoutHit() && ub == std::numeric_limits<double>::max())
             return MTSP_VRP_C_NO_RESULT_TIMEOUT;
 
-        size_t offset = 0;
-        for (size_t a = 0; a < numberOfAgents; ++a)
-        {
-            pathOffsets[a] = offset; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-            auto length = result.GetPaths()[a].size();
-            if (startPositions[a] == endPositions[a])
-                --length; // don't copy unneeded (duplicate) last entry
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-            std::copy_n(result.GetPaths()[a].begin(), length, paths + offset);
-            offset += length;
-        }
+        CopyPaths(result.GetPaths(), startPositions, endPositions, paths, pathOffsets);
 
         if (lb >= ub)
             return MTSP_VRP_C_RESULT_SOLVED;
 
+        if (solveMode == MTSP_VRP_C_SOLVE_MODE_HEURISTIC
+            || solveMode == MTSP_VRP_C_SOLVE_MODE_DECOMPOSITION)
+            return MTSP_VRP_C_RESULT_HEURISTIC;
+
         assert(result.IsTimeoutHit());
         return MTSP_VRP_C_RESULT_TIMEOUT;
     }
@@ -105,3 +161,84 @@ int solve_mtsp_vrp(
         return INT_MIN;
     }
 }
+
+int solve_mtsp_vrp_coordinates(
+    size_t numberOfAgents, size_t numberOfNodes, const size_t* start_positions,
+    const size_t* end_positions, const double* x, const double* y, int distanceFunction,
+    int optimizationMode, int timeout_ms, size_t numberOfThreads, double* lowerBound,
+    double* upperBound, size_t* paths, size_t* pathOffsets)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+
+    if (numberOfAgents == 0 || numberOfNodes < 2 || numberOfAgents * 2 > numberOfNodes)
+        return MTSP_VRP_C_NO_RESULT_INVALID_INPUT_SIZE;
+
+    if (start_positions == nullptr || end_positions == nullptr || x == nullptr || y == nullptr
+        || lowerBound == nullptr || upperBound == nullptr || paths == nullptr
+        || pathOffsets == nullptr)
+        return MTSP_VRP_C_NO_RESULT_INVALID_INPUT_POINTER;
+
+    if (optimizationMode != MTSP_VRP_C_OPTIMIZATION_MODE_SUM
+        && optimizationMode != MTSP_VRP_C_OPTIMIZATION_MODE_MAX)
+        return MTSP_VRP_C_INVALID_OPTIMIZATION_MODE;
+
+    if (distanceFunction < MTSP_VRP_C_DISTANCE_FUNCTION_EUC_2D
+        || distanceFunction > MTSP_VRP_C_DISTANCE_FUNCTION_GEO)
+        return MTSP_VRP_C_INVALID_DISTANCE_FUNCTION;
+
+    for (size_t a = 0; a < numberOfAgents; ++a)
+    {
+        if (start_positions[a] >= numberOfNodes || end_positions[a] >= numberOfNodes)
+            return MTSP_VRP_C_NO_RESULT_INVALID_INPUT_SIZE;
+    }
+
+    const std::array positionsShape = { numberOfAgents };
+    const xt::xtensor<size_t, 1> startPositions
+        = xt::adapt(start_positions, numberOfAgents, xt::no_ownership {}, positionsShape);
+    const xt::xtensor<size_t, 1> endPositions
+        = xt::adapt(end_positions, numberOfAgents, xt::no_ownership {}, positionsShape);
+
+    try
+    {
+        static_assert(
+            tsplp::DistanceFunction::Euc2D
+            == static_cast<tsplp::DistanceFunction>(MTSP_VRP_C_DISTANCE_FUNCTION_EUC_2D));
+        static_assert(
+            tsplp::DistanceFunction::Ceil2D
+            == static_cast<tsplp::DistanceFunction>(MTSP_VRP_C_DISTANCE_FUNCTION_CEIL_2D));
+        static_assert(
+            tsplp::DistanceFunction::Att
+            == static_cast<tsplp::DistanceFunction>(MTSP_VRP_C_DISTANCE_FUNCTION_ATT));
+        static_assert(
+            tsplp::DistanceFunction::Geo
+            == static_cast<tsplp::DistanceFunction>(MTSP_VRP_C_DISTANCE_FUNCTION_GEO));
+
+        const tsplp::CoordinateWeights weights(
+            std::span(x, numberOfNodes), std::span(y, numberOfNodes),
+            static_cast<tsplp::DistanceFunction>(distanceFunction));
+
+        // local search alone converges slowly on large single tours, where the multilevel
+        // scheme starts from the expanded solutions of the coarser levels
+        constexpr size_t minMultilevelN = 10000;
+        const auto solve = numberOfAgents == 1 && numberOfNodes >= minMultilevelN
+            ? &tsplp::MultilevelSolve
+            : &tsplp::HeuristicSolve;
+
+        const auto [resultPaths, objective] = solve(
+            static_cast<tsplp::OptimizationMode>(optimizationMode), weights, startPositions,
+            endPositions, startTime + std::chrono::milliseconds { timeout_ms },
+            numberOfThreads > 0 ? numberOfThreads : std::thread::hardware_concurrency());
+
+        // all weights are non-negative
+        *lowerBound = 0.0;
+        *upperBound = objective;
+
+        CopyPaths(resultPaths, startPositions, endPositions, paths, pathOffsets);
+
+        return MTSP_VRP_C_RESULT_HEURISTIC;
+    }
+    catch (...)
+    {
+        return INT_MIN;
+    }
+}
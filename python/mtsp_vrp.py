@@ -2,19 +2,21 @@ from ctypes import *
 import numpy as np
 from numpy.ctypeslib import as_array, ndpointer
 from os import path
+from sys import float_info
 
 with open(path.join(path.dirname(path.abspath(__file__)), '_mtsp_vrp_c_lib_path.txt')) as f:
     _mtsp_vrp_c_lib_path = f.readline()
 
-_solve_mtsp_vrp = cdll.LoadLibrary(_mtsp_vrp_c_lib_path).solve_mtsp_vrp
-_solve_mtsp_vrp.restype = c_int
-_solve_mtsp_vrp.argtypes = [
+_solve_mtsp_vrp_with_mode = cdll.LoadLibrary(_mtsp_vrp_c_lib_path).solve_mtsp_vrp_with_mode
+_solve_mtsp_vrp_with_mode.restype = c_int
+_solve_mtsp_vrp_with_mode.argtypes = [
     c_size_t, # numberOfAgents
     c_size_t, # numberOfNodes
     ndpointer(c_size_t, flags='C_CONTIGUOUS'), # start_positions
     ndpointer(c_size_t, flags='C_CONTIGUOUS'), # end_positions
     ndpointer(c_int, flags='C_CONTIGUOUS'), # weights
     c_int, # optimizationMode
+    c_int, # solveMode
     c_int, # timeout
     c_size_t, # numberOfThreads
     POINTER(c_double), # lowerBound
@@ -24,22 +26,64 @@ _solve_mtsp_vrp.argtypes = [
     c_void_p # fractionalCallback
 ]
 
+_solve_mtsp_vrp_coordinates = cdll.LoadLibrary(_mtsp_vrp_c_lib_path).solve_mtsp_vrp_coordinates
+_solve_mtsp_vrp_coordinates.restype = c_int
+_solve_mtsp_vrp_coordinates.argtypes = [
+    c_size_t, # numberOfAgents
+    c_size_t, # numberOfNodes
+    ndpointer(c_size_t, flags='C_CONTIGUOUS'), # start_positions
+    ndpointer(c_size_t, flags='C_CONTIGUOUS'), # end_positions
+    ndpointer(c_double, flags='C_CONTIGUOUS'), # x
+    ndpointer(c_double, flags='C_CONTIGUOUS'), # y
+    c_int, # distanceFunction
+    c_int, # optimizationMode
+    c_int, # timeout
+    c_size_t, # numberOfThreads
+    POINTER(c_double), # lowerBound
+    POINTER(c_double), # upperBound
+    ndpointer(c_size_t, flags='C_CONTIGUOUS'), # paths
+    ndpointer(c_size_t, flags='C_CONTIGUOUS') # pathOffsets
+]
+
+solve_mode_map = {
+    'BRANCH_AND_CUT': 0,
+    'HEURISTIC': 1,
+    'BOUND': 2,
+    'DECOMPOSITION': 3
+}
+
+distance_function_map = {
+    'EUC_2D': 0,
+    'CEIL_2D': 1,
+    'ATT': 2,
+    'GEO': 3
+}
+
 error_code_map = {
     -1: 'Timeout, no result',
     -2: 'Infeasible',
     -3: 'Invalid input size',
     -4: 'Invalid input pointer',
     -5: 'Cyclic dependencies',
-    -6: 'Incompatible dependencies'
+    -6: 'Incompatible dependencies',
+    -7: 'Invalid optimization mode',
+    -8: 'Invalid distance function',
+    -9: 'Invalid solve mode'
 }
 
-def solve_mtsp_vrp(start_positions, end_positions, weights, optimization_mode, timeout, number_of_threads=0, fractional_callback=None):
+# fractional_callback receives the LP values of the arcs as an array of shape (A, N, N). For a single agent on symmetric
+# weights without dependencies, both arcs of an edge get half of its value.
+# solve_mode 'HEURISTIC' skips the LP and only improves heuristic solutions, for instances too large for branch and cut.
+# solve_mode 'BOUND' only computes the lower bound of the root, the fractional callback receives its LP solution.
+# solve_mode 'DECOMPOSITION' solves the path of each agent separately after clustering the nodes, for many agents.
+def solve_mtsp_vrp(start_positions, end_positions, weights, optimization_mode, timeout, number_of_threads=0, fractional_callback=None, solve_mode='BRANCH_AND_CUT'):
     A = len(start_positions)
     N = len(weights)
     start_positions = np.array(start_positions, dtype=np.uint64)
     end_positions = np.array(end_positions, dtype=np.uint64)
     weights = np.array(weights, dtype=np.int32)
     optimization_mode = 1 if str(optimization_mode).upper() in ['MAX', '1'] else 0
+    solve_mode = solve_mode_map.get(str(solve_mode).upper(), -1)
     number_of_threads = int(number_of_threads)
     lb = c_double(0)
     ub = c_double(0)
@@ -55,12 +99,17 @@ def solve_mtsp_vrp(start_positions, end_positions, weights, optimization_mode, t
     else:
         fractional_callback_c = None
 
-    result = _solve_mtsp_vrp(A, N, start_positions, end_positions, weights, optimization_mode, timeout,
-                             number_of_threads, byref(lb), byref(ub), pathsBuffer, offsets, fractional_callback_c)
+    result = _solve_mtsp_vrp_with_mode(A, N, start_positions, end_positions, weights, optimization_mode, solve_mode,
+                                       timeout, number_of_threads, byref(lb), byref(ub), pathsBuffer, offsets,
+                                       fractional_callback_c)
     if result < 0:
         error = error_code_map.get(result, f'Unknown error code: {result}')
         raise Exception(error)
 
+    # a bound can be found without any paths
+    if ub.value == float_info.max:
+        return [], [], lb.value, ub.value
+
     paths = []
     lengths = []
     for a in range(A):
@@ -74,3 +123,35 @@ def solve_mtsp_vrp(start_positions, end_positions, weights, optimization_mode, t
         lengths.append(length)
 
     return paths, lengths, lb.value, ub.value
+
+
+# Heuristic solution for nodes given by coordinates and a TSPLIB distance function ('EUC_2D', 'CEIL_2D', 'ATT' or 'GEO').
+# No weight matrix is created, so this also works for instances like pla85900. The lower bound is 0.
+def solve_mtsp_vrp_coordinates(start_positions, end_positions, x, y, distance_function, optimization_mode, timeout, number_of_threads=0):
+    A = len(start_positions)
+    N = len(x)
+    start_positions = np.array(start_positions, dtype=np.uint64)
+    end_positions = np.array(end_positions, dtype=np.uint64)
+    x = np.array(x, dtype=np.float64)
+    y = np.array(y, dtype=np.float64)
+    distance_function = distance_function_map.get(str(distance_function).upper(), -1)
+    optimization_mode = 1 if str(optimization_mode).upper() in ['MAX', '1'] else 0
+    number_of_threads = int(number_of_threads)
+    lb = c_double(0)
+    ub = c_double(0)
+    pathsBuffer = np.zeros(shape=(2 * A + N,), dtype=np.uint64)
+    offsets = np.zeros(shape=(A,), dtype=np.uint64)
+
+    result = _solve_mtsp_vrp_coordinates(A, N, start_positions, end_positions, x, y, distance_function, optimization_mode,
+                                         timeout, number_of_threads, byref(lb), byref(ub), pathsBuffer, offsets)
+    if result < 0:
+        error = error_code_map.get(result, f'Unknown error code: {result}')
+        raise Exception(error)
+
+    paths = []
+    for a in range(A):
+        start = offsets[a]
+        end = offsets[a+1] if a+1 < A else N
+        paths.append(list(np.array(pathsBuffer[start:end])))
+
+    return paths, lb.value, ub.value
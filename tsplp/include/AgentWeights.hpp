@@ -0,0 +1,66 @@
+#pragma once
+
+#include "WeightsView.hpp"
+
+#include <xtensor/xarray.hpp>
+#include <xtensor/xtensor.hpp>
+
+#include <cassert>
+#include <cstddef>
+
+namespace tsplp
+{
+// The weight of an arc as seen by an agent. All agents share the same N x N matrix, optionally
+// scaled by 1 - x(a, u, v) for a fractional solution x. The scaling is evaluated on access, so no
+// A x N x N tensor has to be materialised. Does not own the referenced tensors, and the fractional
+// solution has to be stored contiguously in row-major order.
+class AgentWeights
+{
+private:
+    WeightsView m_weights;
+    const double* m_fractionalSolution = nullptr;
+
+public:
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    AgentWeights(WeightsView weights)
+        : m_weights(weights)
+    {
+    }
+
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    AgentWeights(const xt::xtensor<double, 2>& weights)
+        : m_weights(weights)
+    {
+    }
+
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    AgentWeights(const xt::xarray<double>& weights)
+        : m_weights(weights)
+    {
+    }
+
+    AgentWeights(WeightsView weights, const xt::xtensor<double, 3>& fractionalSolution)
+        : m_weights(weights)
+        , m_fractionalSolution(fractionalSolution.data())
+    {
+        assert(fractionalSolution.shape(1) == m_weights.N());
+        assert(fractionalSolution.shape(2) == m_weights.N());
+    }
+
+    [[nodiscard]] size_t N() const { return m_weights.N(); }
+    [[nodiscard]] WeightsView Base() const { return m_weights; }
+    // nullptr if the weights are not scaled
+    [[nodiscard]] const double* FractionalSolution() const { return m_fractionalSolution; }
+
+    [[nodiscard]] double operator()(size_t a, size_t u, size_t v) const
+    {
+        const auto w = m_weights(u, v);
+        if (m_fractionalSolution == nullptr)
+            return w;
+
+        const auto N = m_weights.N();
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return (1.0 - m_fractionalSolution[(a * N + u) * N + v]) * w;
+    }
+};
+}
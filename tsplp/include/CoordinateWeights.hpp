@@ -0,0 +1,98 @@
+#pragma once
+
+#include "TsplpExceptions.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <span>
+
+namespace tsplp
+{
+// The distance functions of TSPLIB for nodes given by 2D coordinates. All of them are symmetric
+// and rounded to integral values.
+enum class DistanceFunction
+{
+    Euc2D,
+    Ceil2D,
+    Att,
+    Geo
+};
+
+// Non-owning weights of nodes given by coordinates, computed on access instead of being stored in
+// an N x N matrix, which would not fit into memory for instances like pla85900. Like WeightsView,
+// it is cheap to copy and passed by value, and the coordinates have to outlive it. For Geo, x is
+// the latitude and y the longitude, both in TSPLIB's DDD.MM format.
+class CoordinateWeights
+{
+private:
+    std::span<const double> m_x;
+    std::span<const double> m_y;
+    DistanceFunction m_distanceFunction;
+
+public:
+    CoordinateWeights(
+        std::span<const double> x, std::span<const double> y, DistanceFunction distanceFunction)
+        : m_x(x)
+        , m_y(y)
+        , m_distanceFunction(distanceFunction)
+    {
+        assert(m_x.size() == m_y.size());
+    }
+
+    [[nodiscard]] size_t N() const { return m_x.size(); }
+    [[nodiscard]] double X(size_t n) const { return m_x[n]; }
+    [[nodiscard]] double Y(size_t n) const { return m_y[n]; }
+    [[nodiscard]] DistanceFunction GetDistanceFunction() const { return m_distanceFunction; }
+
+    // Latitude and longitude of a Geo node in radians, as defined by TSPLIB.
+    [[nodiscard]] static double ToGeoRadians(double coordinate)
+    {
+        constexpr double pi = 3.141592;
+        const auto degrees = std::trunc(coordinate);
+        const auto minutes = coordinate - degrees;
+        return pi * (degrees + 5.0 * minutes / 3.0) / 180.0;
+    }
+
+    [[nodiscard]] double operator()(size_t u, size_t v) const
+    {
+        assert(u < N() && v < N());
+
+        // TSPLIB's Geo distance of a node to itself would be 1
+        if (u == v)
+            return 0.0;
+
+        const auto dx = m_x[u] - m_x[v];
+        const auto dy = m_y[u] - m_y[v];
+
+        switch (m_distanceFunction)
+        {
+        case DistanceFunction::Euc2D:
+            return std::floor(std::sqrt(dx * dx + dy * dy) + 0.5);
+        case DistanceFunction::Ceil2D:
+            return std::ceil(std::sqrt(dx * dx + dy * dy));
+        case DistanceFunction::Att:
+        {
+            const auto r = std::sqrt((dx * dx + dy * dy) / 10.0);
+            const auto t = std::floor(r + 0.5);
+            return t < r ? t + 1.0 : t;
+        }
+        case DistanceFunction::Geo:
+        {
+            constexpr double earthRadius = 6378.388;
+            const auto latitudeU = ToGeoRadians(m_x[u]);
+            const auto latitudeV = ToGeoRadians(m_x[v]);
+            const auto q1 = std::cos(ToGeoRadians(m_y[u]) - ToGeoRadians(m_y[v]));
+            const auto q2 = std::cos(latitudeU - latitudeV);
+            const auto q3 = std::cos(latitudeU + latitudeV);
+            // rounding errors must not leave the domain of acos
+            const auto cosine = std::min(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3), 1.0);
+            return std::floor(earthRadius * std::acos(cosine) + 1.0);
+        }
+        default:
+            throw TsplpException();
+        }
+    }
+};
+}
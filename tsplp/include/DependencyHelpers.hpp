@@ -18,16 +18,22 @@ private:
     std::vector<std::pair<size_t, size_t>> m_node2incomingSpanMap;
     std::vector<std::pair<size_t, size_t>> m_node2outgoingSpanMap;
 
-    const xt::xtensor<double, 2>& m_weights;
+    // nullptr if there are no dependencies
+    const xt::xtensor<double, 2>* m_weights;
 
 public:
     explicit DependencyGraph(const xt::xtensor<double, 2>& weights);
+    // N nodes without dependencies, e.g. for instances that are too large for a weight matrix
+    explicit DependencyGraph(size_t N);
 
     [[nodiscard]] const auto& GetArcs() const { return m_arcs; }
     [[nodiscard]] std::span<const size_t> GetIncomingSpan(size_t n) const;
     [[nodiscard]] std::span<const size_t> GetOutgoingSpan(size_t n) const;
 
-    [[nodiscard]] bool HasArc(size_t u, size_t v) const { return m_weights(v, u) == -1; }
+    [[nodiscard]] bool HasArc(size_t u, size_t v) const
+    {
+        return m_weights != nullptr && (*m_weights)(v, u) == -1;
+    }
     [[nodiscard]] bool IsEmpty() const { return m_arcs.empty(); }
 };
 }
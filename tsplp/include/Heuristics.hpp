@@ -1,38 +1,137 @@
 #pragma once
 
+#include "AgentWeights.hpp"
+#include "CoordinateWeights.hpp"
 #include "MtspModel.hpp"
+#include "WeightsView.hpp"
 
 #include <xtensor/xarray.hpp>
 #include <xtensor/xtensor.hpp>
 #include <xtensor/xview.hpp>
 
+#include <chrono>
+#include <cstdint>
+#include <limits>
 #include <tuple>
 #include <vector>
 
 namespace tsplp
 {
 class DependencyGraph;
+class NeighborLists;
 
 [[nodiscard]] std::vector<std::vector<size_t>> ExploitFractionalSolution(
-    OptimizationMode optimizationMode, xt::xarray<double> fractionalSolution,
-    xt::xarray<double> weights, const xt::xtensor<size_t, 1>& startPositions,
+    OptimizationMode optimizationMode, const xt::xtensor<double, 3>& fractionalSolution,
+    WeightsView weights, const xt::xtensor<size_t, 1>& startPositions,
     const xt::xtensor<size_t, 1>& endPositions, const DependencyGraph& dependencies,
     std::chrono::steady_clock::time_point endTime);
 
+// With neighbor lists, a node is only inserted next to one of its nearest neighbors if possible.
 [[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertion(
-    OptimizationMode optimizationMode, xt::xarray<double> weights,
+    OptimizationMode optimizationMode, const AgentWeights& weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
+    const DependencyGraph& dependencies, std::chrono::steady_clock::time_point endTime,
+    const NeighborLists* neighborLists = nullptr);
+
+// Repeatedly inserts the node that is cheapest to insert, considering dependencies. The best slot
+// of each node in each path is cached and only updated around the latest insertion.
+[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> CheapestInsertion(
+    OptimizationMode optimizationMode, const AgentWeights& weights,
     const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
     const DependencyGraph& dependencies, std::chrono::steady_clock::time_point endTime);
 
-[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> TwoOptPaths(
-    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths,
-    xt::xarray<double> weights, const DependencyGraph& dependencies,
+// The node inserted next by RandomizedInsertion: the one that is cheapest to insert, the one that
+// is most expensive to insert, or the one that loses most if it is not inserted into its best path.
+enum class InsertionCriterion
+{
+    Cheapest,
+    Farthest,
+    Regret
+};
+
+// Insertion of the node chosen by the criterion at its cheapest position, considering
+// dependencies. The key of each node is scaled by a random factor in [1, 1 + noise), so different
+// seeds give different starting points for local search.
+[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> RandomizedInsertion(
+    OptimizationMode optimizationMode, const AgentWeights& weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
+    const DependencyGraph& dependencies, InsertionCriterion criterion, std::uint64_t seed,
+    double noise, std::chrono::steady_clock::time_point endTime);
+
+// Clarke-Wright savings: chains of nodes are merged along the arcs of the neighbor lists with the
+// largest, randomly scaled, savings while there are more than A chains. Each chain is then
+// appended to the path where this is cheapest. Dependencies are not supported.
+[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> SavingsPaths(
+    OptimizationMode optimizationMode, WeightsView weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
+    const NeighborLists& neighborLists, std::uint64_t seed, double noise,
     std::chrono::steady_clock::time_point endTime);
 
+// Ruin and recreate on all threads, starting from the given paths, until endTime or until the
+// lower bound is reached. Random, radial or worst path removal is repaired by regret insertion
+// that respects the dependencies, and accepted like in simulated annealing. The threads share the
+// incumbent, which is improved by local search.
+[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> LargeNeighborhoodSearch(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths, WeightsView weights,
+    const DependencyGraph& dependencies, const NeighborLists& neighborLists,
+    std::chrono::steady_clock::time_point endTime, size_t numberOfThreads = 1,
+    double lowerBound = std::numeric_limits<double>::lowest());
+
+// Assigns the nodes to the agents in whole dependency components, so that every agent gets about
+// the same number of nodes. Agents without nodes of their own are seeded by farthest-first
+// traversal, then the smallest cluster repeatedly takes the component of the nearest remaining
+// node. Returns the nodes of each cluster, without the start and end nodes.
+[[nodiscard]] std::vector<std::vector<size_t>> BalancedClusters(
+    WeightsView weights, const xt::xtensor<size_t, 1>& startPositions,
+    const xt::xtensor<size_t, 1>& endPositions, const DependencyGraph& dependencies);
+
+[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> LocalSearchPaths(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths, WeightsView weights,
+    const DependencyGraph& dependencies, const NeighborLists& neighborLists,
+    std::chrono::steady_clock::time_point endTime);
+
+[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> LocalSearchPaths(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths,
+    CoordinateWeights weights, const DependencyGraph& dependencies,
+    const NeighborLists& neighborLists, std::chrono::steady_clock::time_point endTime);
+
+// Paths of successive nearest neighbors, found with a k-d tree. Every path gets the same number of
+// nodes, local search rebalances them afterwards. Dependencies are not supported.
+[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> NearestNeighborPaths(
+    OptimizationMode optimizationMode, CoordinateWeights weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions);
+
+// Solves instances that are too large for a weight matrix without an LP: nearest neighbor paths,
+// improved by local search on nearest neighbor lists until endTime. Needs O(N) memory. Start and
+// end nodes may be shared by several agents, like for WeightManager.
+[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> HeuristicSolve(
+    OptimizationMode optimizationMode, CoordinateWeights weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
+    std::chrono::steady_clock::time_point endTime, size_t numberOfThreads = 1);
+
+// Multilevel variant of HeuristicSolve for very large instances: nearest free nodes are contracted
+// in pairs into nodes at their midpoint, until at most 1000 nodes are left. The coarsest level is
+// solved by HeuristicSolve, and the paths are expanded level by level, each time improved by local
+// search of segments in parallel and then of the whole paths.
+[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> MultilevelSolve(
+    OptimizationMode optimizationMode, CoordinateWeights weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
+    std::chrono::steady_clock::time_point endTime, size_t numberOfThreads = 1);
+
+[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> TwoOptPaths(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths, WeightsView weights,
+    const DependencyGraph& dependencies, std::chrono::steady_clock::time_point endTime);
+
+[[nodiscard]] double CalculatePathLength(const std::vector<size_t>& path, WeightsView weights);
+
 [[nodiscard]] double CalculatePathLength(
-    const std::vector<size_t>& path, xt::xarray<double> weights);
+    const std::vector<size_t>& path, CoordinateWeights weights);
+
+[[nodiscard]] double CalculateObjective(
+    OptimizationMode optimizationMode, const std::vector<std::vector<size_t>>& paths,
+    WeightsView weights);
 
 [[nodiscard]] double CalculateObjective(
     OptimizationMode optimizationMode, const std::vector<std::vector<size_t>>& paths,
-    xt::xarray<double> weights);
+    CoordinateWeights weights);
 }
@@ -26,6 +26,11 @@ private:
     std::vector<Variable> m_variables;
     size_t m_numberOfBinaryVariables = 0;
 
+    // The column of each variable in the simplex model, or -1 if Compact removed it. A removed
+    // variable keeps its value from m_removedValues.
+    std::vector<int> m_columns;
+    std::vector<double> m_removedValues;
+
 public:
     Model();
     explicit Model(size_t numberOfBinaryVariables);
@@ -44,6 +49,12 @@ public:
     void AddConstraints(RandIterator first, RandIterator last);
     Variable AddVariable(double lowerBound, double upperBound);
     Status Solve(std::chrono::steady_clock::time_point endTime);
+
+    // Removes the columns of the fixed binary variables, with their contribution moved into the
+    // row bounds and the objective offset, and then the rows that cannot be violated anymore. The
+    // variables keep their ids, and the removed ones must not be fixed to another value afterwards.
+    // Later constraints and objectives may still use them. Returns the number of removed columns.
+    size_t Compact();
 };
 
 void swap(Model& m1, Model& m2) noexcept;
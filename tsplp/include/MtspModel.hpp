@@ -12,10 +12,15 @@
 #include <chrono>
 #include <functional>
 #include <optional>
+#include <tuple>
 #include <vector>
 
 namespace tsplp
 {
+class ArcDomains;
+class ConstraintDeque;
+class SolutionMailbox;
+
 enum class OptimizationMode
 {
     Sum,
@@ -44,35 +49,104 @@ private:
     Model m_model;
     xt::xtensor<Variable, 3> X;
 
+    // Whether X(0, u, v) and X(0, v, u) are the same edge variable, see CreateLinearProgram.
+    bool m_isUndirected = false;
+
     LinearObjective m_objective;
 
     MtspResult m_bestResult {};
 
+    // the paths of the initial result, in the node numbering of the weight manager
+    std::vector<std::vector<size_t>> m_initialPaths;
+
     std::string m_name;
 
 public:
+    // The initial result is found by a randomized multi-start on noOfThreads threads, all hardware
+    // threads by default. Models that are solved in parallel with others should use a single one.
     MtspModel(
         xt::xtensor<size_t, 1> startPositions, xt::xtensor<size_t, 1> endPositions,
         xt::xtensor<double, 2> weights, OptimizationMode optimizationMode,
-        std::chrono::milliseconds timeout, std::string name = "Model");
+        std::chrono::milliseconds timeout, std::string name = "Model",
+        std::optional<size_t> noOfThreads = std::nullopt);
 
 public:
+    // With backgroundHeuristic, an additional thread improves the upper bound from the fractional
+    // solutions of the branch and cut threads, which then never stop to exploit or dive from them
+    // themselves.
+    // For a single agent on symmetric weights without dependencies, the LP has one column per edge
+    // instead of two arcs, and the fractional solution holds half of each edge value in either
+    // direction.
+    // A single agent on at most MaxHeldKarpN nodes is solved by HeldKarpSolve instead, unless there
+    // is a fractionalCallback, which needs the LP, or allowHeldKarp is false.
     void BranchAndCutSolve(
+        std::optional<size_t> noOfThreads = std::nullopt,
+        std::function<void(const xt::xtensor<double, 3>&)> fractionalCallback = nullptr,
+        bool backgroundHeuristic = false, bool allowHeldKarp = true);
+
+    // Spends the time until the timeout on improving the initial result, on all threads, without
+    // creating the LP: large neighborhood search for multiple agents and iterated local search for
+    // a single one. Only a cheap lower bound is provided.
+    void HeuristicSolve(std::optional<size_t> noOfThreads = std::nullopt);
+
+    // Cluster first, route second, for many agents where the full model is too large: the nodes
+    // are assigned to the agents in balanced clusters, whose paths are solved by separate
+    // single-agent models in parallel. Local search then moves nodes between the clusters, and the
+    // changed ones are solved again, until no node moves or the timeout is hit. The remaining time
+    // is spent on OptimizeWindows.
+    void DecompositionSolve(std::optional<size_t> noOfThreads = std::nullopt);
+
+    // Only the root of branch and cut: adds cuts of all separation algorithms, separated in
+    // parallel, until none are found or the bound tails off. There is no branching and no primal
+    // heuristic besides the initial result. The callback receives the final fractional solution.
+    void BoundSolve(
         std::optional<size_t> noOfThreads = std::nullopt,
         std::function<void(const xt::xtensor<double, 3>&)> fractionalCallback = nullptr);
 
     [[nodiscard]] const MtspResult& GetResult() const { return m_bestResult; }
 
 private:
-    void CreateInitialResult();
+    // gives the tests access to the primal heuristics of branch and cut
+    friend struct MtspModelTestAccess;
+
+    void CreateLinearProgram();
+    void CreateInitialResult(size_t threadCount);
+    void IteratedLocalSearch(size_t threadCount);
+
+    // Runs the cut loop on the root LP, then fixes the arcs whose reduced costs rule them out of
+    // any solution better than the upper bound, together with everything this implies. Once
+    // enough arcs are fixed, the model is compacted, so the threads copy the smaller one, which
+    // keeps the root cuts.
+    void RestartAtRoot(ArcDomains& rootDomains);
+
+    // Exact for a single agent on at most MaxHeldKarpN nodes, which is faster than any LP there.
+    void HeldKarpSolve();
     double ExploitFractionalSolution(const xt::xtensor<double, 3>& fractionalValues);
 
+    // LP diving on a copy of a branch and cut model: repeatedly fixes the arcs that are nearly 1,
+    // together with everything that this implies, and resolves, separating cuts in between, until
+    // the solution is integral, infeasible or worse than the upper bound. Returns the upper bound.
+    double Dive(Model model, ConstraintDeque& constraints);
+    void RunPrimalHeuristic(SolutionMailbox& mailbox, ConstraintDeque& constraints);
+
     [[nodiscard]] std::vector<std::vector<size_t>> CreatePathsFromVariables(
         const Model& model) const;
 
     [[nodiscard]] std::vector<Variable> CalculateRecursivelyFixableVariables(Variable var) const;
 };
 
+// POPMUSIC-like polishing of paths given in the numbering of the weights: windows of windowSize
+// consecutive nodes are solved to optimality by an MtspModel with the first and last node of the
+// window as start and end, and spliced back in if they are shorter. Windows that do not overlap
+// are solved in parallel. Passes alternate between windows shifted by half their size until a
+// full cycle brings no improvement or endTime is reached.
+constexpr size_t DefaultWindowSize = 40;
+
+[[nodiscard]] std::tuple<std::vector<std::vector<size_t>>, double> OptimizeWindows(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths,
+    const xt::xtensor<double, 2>& weights, std::chrono::steady_clock::time_point endTime,
+    size_t windowSize = DefaultWindowSize, size_t numberOfThreads = 1);
+
 [[nodiscard]] LinearObjective CreateObjective(
     xt::xarray<double> weights, xt::xarray<Variable> variables,
     std::optional<Variable> maxVariable);
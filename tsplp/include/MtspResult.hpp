@@ -27,6 +27,10 @@ public:
     [[nodiscard]] bool IsTimeoutHit() const;
     [[nodiscard]] const auto& GetPaths() const { return m_paths; }
 
+    // A copy of the paths taken under the lock, for threads that read them while others may
+    // update them.
+    [[nodiscard]] std::vector<std::vector<size_t>> CopyPaths() const;
+
     void SetTimeoutHit();
     Bounds UpdateUpperBound(double newUpperBound, std::vector<std::vector<size_t>>&& newPaths);
     Bounds UpdateLowerBound(double newLowerBound);
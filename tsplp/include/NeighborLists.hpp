@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CoordinateWeights.hpp"
+
+#include <xtensor/xtensor.hpp>
+
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace tsplp
+{
+// For each node, the k nearest successors (outgoing) and predecessors (incoming) with respect to
+// the given weights, ordered by increasing weight. Self referring arcs and arcs with negative
+// weights (i.e. reverse arcs of dependencies) are never part of the lists.
+// Alternatively, the lists can be ordered by alpha-nearness with respect to a minimum spanning tree
+// of the symmetrized weights, i.e. by the increase of the tree weight when the arc is enforced into
+// the tree. Ties are broken by weight.
+class NeighborLists
+{
+public:
+    enum class Measure
+    {
+        Weight,
+        AlphaNearness
+    };
+
+private:
+    std::vector<size_t> m_outgoing;
+    std::vector<size_t> m_incoming;
+
+    std::vector<std::pair<size_t, size_t>> m_node2outgoingSpanMap;
+    std::vector<std::pair<size_t, size_t>> m_node2incomingSpanMap;
+
+public:
+    static constexpr size_t DefaultK = 10;
+
+    explicit NeighborLists(
+        const xt::xtensor<double, 2>& weights, size_t k = DefaultK,
+        Measure measure = Measure::Weight, size_t numberOfThreads = 1);
+
+    // Nearest neighbors by weight, found with a k-d tree in O(N log N) time and O(N k) memory.
+    // The weights are symmetric, so the incoming lists equal the outgoing lists.
+    explicit NeighborLists(
+        CoordinateWeights weights, size_t k = DefaultK, size_t numberOfThreads = 1);
+
+    [[nodiscard]] std::span<const size_t> GetOutgoingSpan(size_t n) const;
+    [[nodiscard]] std::span<const size_t> GetIncomingSpan(size_t n) const;
+};
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DependencyHelpers.hpp"
+#include "NeighborLists.hpp"
 
 #include <xtensor/xtensor.hpp>
 
@@ -17,6 +18,8 @@ private:
     xt::xtensor<size_t, 1> m_endPositions;
     std::vector<size_t> m_toOriginal;
     std::unique_ptr<DependencyGraph> m_spDependencies;
+    std::unique_ptr<NeighborLists> m_spNeighborLists;
+    std::vector<std::vector<size_t>> m_agentClasses;
     size_t m_originalN;
 
     [[nodiscard]] size_t ToOriginal(size_t i) const;
@@ -32,10 +35,20 @@ public:
     [[nodiscard]] auto A() const { return m_startPositions.shape(0); };
     [[nodiscard]] auto N() const { return m_weights.shape(0); }
     [[nodiscard]] const auto& Dependencies() const { return *m_spDependencies; }
+    [[nodiscard]] const auto& Neighbors() const { return *m_spNeighborLists; }
+
+    // Groups of at least two agents, in ascending order, which share their original start and end
+    // position. Their paths can be permuted among them without changing the objective.
+    [[nodiscard]] const auto& AgentClasses() const { return m_agentClasses; }
 
     [[nodiscard]] std::vector<std::vector<size_t>> TransformPathsBack(
         std::vector<std::vector<size_t>> paths) const;
 
+    // The inverse of TransformPathsBack. Only start and end nodes are copied, so only the first
+    // and last node of each path change.
+    [[nodiscard]] std::vector<std::vector<size_t>> TransformPaths(
+        std::vector<std::vector<size_t>> paths) const;
+
     [[nodiscard]] xt::xtensor<double, 3> TransformTensorBack(
         const xt::xtensor<double, 3>& tensor) const;
 };
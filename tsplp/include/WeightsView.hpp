@@ -0,0 +1,61 @@
+#pragma once
+
+#include <xtensor/xarray.hpp>
+#include <xtensor/xtensor.hpp>
+
+#include <cassert>
+#include <cstddef>
+
+namespace tsplp
+{
+// Non-owning view of an N x N weight matrix, usually the one owned by the WeightManager. It is
+// cheap to copy and therefore passed by value. The referenced tensor has to outlive the view.
+class WeightsView
+{
+private:
+    const double* m_data;
+    size_t m_N;
+    size_t m_rowStride;
+    size_t m_columnStride;
+
+public:
+    WeightsView(const double* data, size_t N, size_t rowStride, size_t columnStride)
+        : m_data(data)
+        , m_N(N)
+        , m_rowStride(rowStride)
+        , m_columnStride(columnStride)
+    {
+    }
+
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    WeightsView(const xt::xtensor<double, 2>& weights)
+        : WeightsView(
+            weights.data(), weights.shape(0), static_cast<size_t>(weights.strides()[0]),
+            static_cast<size_t>(weights.strides()[1]))
+    {
+        assert(weights.shape(1) == m_N);
+    }
+
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    WeightsView(const xt::xarray<double>& weights)
+        : WeightsView(
+            weights.data(), weights.shape(0), static_cast<size_t>(weights.strides()[0]),
+            static_cast<size_t>(weights.strides()[1]))
+    {
+        assert(weights.dimension() == 2);
+        assert(weights.shape(1) == m_N);
+    }
+
+    [[nodiscard]] size_t N() const { return m_N; }
+    [[nodiscard]] const double* Data() const { return m_data; }
+    [[nodiscard]] size_t RowStride() const { return m_rowStride; }
+    [[nodiscard]] size_t ColumnStride() const { return m_columnStride; }
+
+    [[nodiscard]] double operator()(size_t u, size_t v) const
+    {
+        assert(u < m_N && v < m_N);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return m_data[u * m_rowStride + v * m_columnStride];
+    }
+};
+}
@@ -0,0 +1,367 @@
+#include "ArcDomains.hpp"
+
+#include "WeightManager.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <tuple>
+
+namespace tsplp
+{
+namespace
+{
+constexpr size_t bitsPerWord = 64;
+
+// the number of set bits in the rows of node n of all agents, and the agent and the other node of
+// the last one
+std::tuple<size_t, size_t, size_t> CountArcs(
+    const std::vector<std::uint64_t>& rows, size_t n, size_t A, size_t N, size_t wordsPerRow)
+{
+    size_t count = 0;
+    size_t agent = A;
+    size_t other = N;
+    for (size_t a = 0; a < A; ++a)
+    {
+        for (size_t w = 0; w < wordsPerRow; ++w)
+        {
+            const auto word = rows[(a * N + n) * wordsPerRow + w];
+            if (word == 0)
+                continue;
+
+            count += static_cast<size_t>(std::popcount(word));
+            agent = a;
+            other = w * bitsPerWord + static_cast<size_t>(std::countr_zero(word));
+        }
+    }
+
+    return { count, agent, other };
+}
+}
+
+ArcDomains::ArcDomains(const WeightManager& weightManager)
+    : m_weightManager(&weightManager)
+    , m_A(weightManager.A())
+    , m_N(weightManager.N())
+    , m_wordsPerRow((m_N + bitsPerWord - 1) / bitsPerWord)
+    , m_successors(m_A * m_N * m_wordsPerRow, 0)
+    , m_predecessors(m_A * m_N * m_wordsPerRow, 0)
+    , m_fixedSuccessors(m_N, m_N)
+    , m_fixedPredecessors(m_N, m_N)
+    , m_isStart(m_N, false)
+    , m_isEnd(m_N, false)
+    , m_isQueued(m_N, false)
+{
+    for (size_t a = 0; a < m_A; ++a)
+    {
+        for (size_t u = 0; u < m_N; ++u)
+        {
+            for (size_t v = 0; v < m_N; ++v)
+            {
+                if (u == v)
+                    continue;
+
+                m_successors[(a * m_N + u) * m_wordsPerRow + v / bitsPerWord]
+                    |= std::uint64_t { 1 } << (v % bitsPerWord);
+                m_predecessors[(a * m_N + v) * m_wordsPerRow + u / bitsPerWord]
+                    |= std::uint64_t { 1 } << (u % bitsPerWord);
+            }
+        }
+    }
+
+    const auto& startPositions = weightManager.StartPositions();
+    const auto& endPositions = weightManager.EndPositions();
+
+    // only the own agent leaves its start and enters its end
+    for (size_t a = 0; a < m_A; ++a)
+    {
+        m_isStart[startPositions[a]] = true;
+        m_isEnd[endPositions[a]] = true;
+
+        for (size_t b = 0; b < m_A; ++b)
+        {
+            if (b != a)
+            {
+                RemoveOutgoingArcs(b, startPositions[a]);
+                RemoveIncomingArcs(b, endPositions[a]);
+            }
+        }
+    }
+
+    const auto& dependencies = weightManager.Dependencies();
+    for (const auto& [u, v] : dependencies.GetArcs())
+    {
+        // for a single agent, the reverse arc of a dependency from start to end is the artificial
+        // one, see CreateLinearProgram
+        if (m_A > 1 || u != startPositions[0] || v != endPositions[0])
+            RemoveArcs(v, u);
+
+        for (const auto s : startPositions)
+        {
+            if (s != u)
+                RemoveArcs(s, v);
+        }
+
+        for (const auto e : endPositions)
+        {
+            if (e != v)
+                RemoveArcs(u, e);
+        }
+
+        // the dependencies are transitive, so a node that has to be visited in between is a
+        // dependee of u and a depender of v
+        const auto dependees = dependencies.GetOutgoingSpan(u);
+        if (std::any_of(
+                dependees.begin(), dependees.end(),
+                [&](size_t w) { return dependencies.HasArc(w, v); }))
+        {
+            RemoveArcs(u, v);
+        }
+    }
+
+    // artificial connections from end to next start
+    for (size_t a = 0; a < m_A; ++a)
+        FixArc(a, endPositions[a], startPositions[(a + 1) % m_A]);
+
+    for (size_t n = 0; n < m_N; ++n)
+        Enqueue(n);
+
+    ProcessQueue();
+}
+
+bool ArcDomains::Propagate(
+    std::span<const Variable> fixedVariables0, std::span<const Variable> fixedVariables1)
+{
+    for (const auto variable : fixedVariables0)
+    {
+        const auto id = variable.GetId();
+        RemoveArc(id / m_N / m_N, (id / m_N) % m_N, id % m_N);
+    }
+
+    for (const auto variable : fixedVariables1)
+    {
+        const auto id = variable.GetId();
+        FixArc(id / m_N / m_N, (id / m_N) % m_N, id % m_N);
+    }
+
+    return ProcessQueue();
+}
+
+bool ArcDomains::IsPossible(size_t a, size_t u, size_t v) const
+{
+    return Test(m_successors, a * m_N + u, v);
+}
+
+bool ArcDomains::IsFixedToOne(size_t a, size_t u, size_t v) const
+{
+    return m_fixedSuccessors[u] == v && IsPossible(a, u, v);
+}
+
+bool ArcDomains::Test(const std::vector<std::uint64_t>& rows, size_t row, size_t n) const
+{
+    return (rows[row * m_wordsPerRow + n / bitsPerWord] >> (n % bitsPerWord) & 1) != 0;
+}
+
+bool ArcDomains::IsRowEmpty(const std::vector<std::uint64_t>& rows, size_t row) const
+{
+    const auto first = rows.begin() + static_cast<std::ptrdiff_t>(row * m_wordsPerRow);
+    return std::all_of(
+        first, first + static_cast<std::ptrdiff_t>(m_wordsPerRow),
+        [](std::uint64_t word) { return word == 0; });
+}
+
+void ArcDomains::Enqueue(size_t n)
+{
+    if (!m_isQueued[n])
+    {
+        m_isQueued[n] = true;
+        m_queue.push_back(n);
+    }
+}
+
+void ArcDomains::RemoveArc(size_t a, size_t u, size_t v)
+{
+    if (!IsPossible(a, u, v))
+        return;
+
+    m_successors[(a * m_N + u) * m_wordsPerRow + v / bitsPerWord]
+        &= ~(std::uint64_t { 1 } << (v % bitsPerWord));
+    m_predecessors[(a * m_N + v) * m_wordsPerRow + u / bitsPerWord]
+        &= ~(std::uint64_t { 1 } << (u % bitsPerWord));
+
+    // the other agents were removed from a fixed arc before it was fixed
+    if (m_fixedSuccessors[u] == v)
+        m_isInfeasible = true;
+
+    Enqueue(u);
+    Enqueue(v);
+}
+
+void ArcDomains::RemoveArcs(size_t u, size_t v)
+{
+    for (size_t a = 0; a < m_A; ++a)
+        RemoveArc(a, u, v);
+}
+
+void ArcDomains::RemoveOutgoingArcs(size_t a, size_t u)
+{
+    for (size_t w = 0; w < m_wordsPerRow; ++w)
+    {
+        for (auto word = m_successors[(a * m_N + u) * m_wordsPerRow + w]; word != 0;
+             word &= word - 1)
+        {
+            RemoveArc(a, u, w * bitsPerWord + static_cast<size_t>(std::countr_zero(word)));
+        }
+    }
+}
+
+void ArcDomains::RemoveIncomingArcs(size_t a, size_t v)
+{
+    for (size_t w = 0; w < m_wordsPerRow; ++w)
+    {
+        for (auto word = m_predecessors[(a * m_N + v) * m_wordsPerRow + w]; word != 0;
+             word &= word - 1)
+        {
+            RemoveArc(a, w * bitsPerWord + static_cast<size_t>(std::countr_zero(word)), v);
+        }
+    }
+}
+
+void ArcDomains::FixArc(size_t a, size_t u, size_t v)
+{
+    if (!IsPossible(a, u, v))
+    {
+        m_isInfeasible = true;
+        return;
+    }
+
+    if (m_fixedSuccessors[u] == v)
+        return;
+
+    // all other arcs leaving u or entering v, no matter which agent
+    for (size_t b = 0; b < m_A; ++b)
+    {
+        for (size_t n = 0; n < m_N; ++n)
+        {
+            if (b != a || n != v)
+                RemoveArc(b, u, n);
+            if (b != a || n != u)
+                RemoveArc(b, n, v);
+        }
+    }
+
+    m_fixedSuccessors[u] = v;
+    m_fixedPredecessors[v] = u;
+
+    // The fixed arcs form chains, and all of them together have to form a single cycle through all
+    // nodes, including the artificial arcs. So a chain must not be closed before it is complete.
+    size_t chainLength = 1;
+    auto tail = v;
+    while (m_fixedSuccessors[tail] != m_N && tail != u)
+    {
+        tail = m_fixedSuccessors[tail];
+        ++chainLength;
+    }
+
+    if (tail == u)
+    {
+        if (chainLength < m_N)
+            m_isInfeasible = true;
+        return;
+    }
+
+    auto head = u;
+    ++chainLength;
+    while (m_fixedPredecessors[head] != m_N)
+    {
+        head = m_fixedPredecessors[head];
+        ++chainLength;
+    }
+
+    if (chainLength < m_N)
+        RemoveArcs(tail, head);
+
+    // Along a path, the dependers of u cannot directly follow v, and the dependees of v cannot
+    // directly precede u. This does not hold across the artificial arcs.
+    if (m_isEnd[u])
+        return;
+
+    const auto& dependencies = m_weightManager->Dependencies();
+    if (!m_isEnd[v])
+    {
+        for (const auto p : dependencies.GetIncomingSpan(u))
+            RemoveArcs(v, p);
+    }
+    if (!m_isStart[u])
+    {
+        for (const auto q : dependencies.GetOutgoingSpan(v))
+            RemoveArcs(q, u);
+    }
+}
+
+void ArcDomains::ProcessNode(size_t n)
+{
+    // every node is left and entered exactly once
+    const auto [outCount, outAgent, successor]
+        = CountArcs(m_successors, n, m_A, m_N, m_wordsPerRow);
+    const auto [inCount, inAgent, predecessor]
+        = CountArcs(m_predecessors, n, m_A, m_N, m_wordsPerRow);
+
+    if (outCount == 0 || inCount == 0)
+    {
+        m_isInfeasible = true;
+        return;
+    }
+
+    if (outCount == 1)
+        FixArc(outAgent, n, successor);
+    if (inCount == 1)
+        FixArc(inAgent, predecessor, n);
+
+    // each node must be entered and left by the same agent, except start nodes which are
+    // artificially entered by the previous agent
+    if (!m_isStart[n])
+    {
+        for (size_t a = 0; a < m_A; ++a)
+        {
+            const auto isLeft = !IsRowEmpty(m_successors, a * m_N + n);
+            const auto isEntered = !IsRowEmpty(m_predecessors, a * m_N + n);
+
+            if (isLeft && !isEntered)
+                RemoveOutgoingArcs(a, n);
+            else if (!isLeft && isEntered)
+                RemoveIncomingArcs(a, n);
+        }
+    }
+
+    if (m_A == 1)
+        return;
+
+    // dependent nodes are left by the same agent, including the start and end nodes, which are
+    // only left by their own one
+    const auto& dependencies = m_weightManager->Dependencies();
+    for (size_t a = 0; a < m_A; ++a)
+    {
+        if (!IsRowEmpty(m_successors, a * m_N + n))
+            continue;
+
+        for (const auto d : dependencies.GetIncomingSpan(n))
+            RemoveOutgoingArcs(a, d);
+        for (const auto d : dependencies.GetOutgoingSpan(n))
+            RemoveOutgoingArcs(a, d);
+    }
+}
+
+bool ArcDomains::ProcessQueue()
+{
+    while (!m_isInfeasible && !m_queue.empty())
+    {
+        const auto n = m_queue.back();
+        m_queue.pop_back();
+        m_isQueued[n] = false;
+
+        ProcessNode(n);
+    }
+
+    return !m_isInfeasible;
+}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Variable.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace tsplp
+{
+class WeightManager;
+
+// The domains of the binary variables X(a, u, v) of the directed formulation, i.e. the ones with
+// id a * N * N + u * N + v, as bitsets of the possible successors and predecessors of each node
+// per agent. Fixings are propagated to a fixpoint with the degree constraints, the flow
+// conservation per agent, the start and end rules and the dependencies, and arcs which would
+// close a chain of fixed arcs to a subtour are removed. The propagation is not complete, so the
+// LP may still be infeasible if it is not detected here.
+class ArcDomains
+{
+private:
+    const WeightManager* m_weightManager;
+    size_t m_A;
+    size_t m_N;
+    size_t m_wordsPerRow;
+
+    // bit v of row a * N + u of m_successors is set iff X(a, u, v) can still be 1, and so is bit
+    // u of row a * N + v of m_predecessors
+    std::vector<std::uint64_t> m_successors;
+    std::vector<std::uint64_t> m_predecessors;
+
+    // the other node of the arc fixed to 1 leaving or entering a node, or N if there is none yet
+    std::vector<size_t> m_fixedSuccessors;
+    std::vector<size_t> m_fixedPredecessors;
+
+    std::vector<bool> m_isStart;
+    std::vector<bool> m_isEnd;
+
+    // the nodes whose domains changed since they were last processed
+    std::vector<size_t> m_queue;
+    std::vector<bool> m_isQueued;
+
+    bool m_isInfeasible = false;
+
+    [[nodiscard]] bool Test(const std::vector<std::uint64_t>& rows, size_t row, size_t n) const;
+    [[nodiscard]] bool IsRowEmpty(const std::vector<std::uint64_t>& rows, size_t row) const;
+
+    void Enqueue(size_t n);
+    void RemoveArc(size_t a, size_t u, size_t v);
+    void RemoveArcs(size_t u, size_t v);
+    void RemoveOutgoingArcs(size_t a, size_t u);
+    void RemoveIncomingArcs(size_t a, size_t v);
+    void FixArc(size_t a, size_t u, size_t v);
+    void ProcessNode(size_t n);
+    bool ProcessQueue();
+
+public:
+    explicit ArcDomains(const WeightManager& weightManager);
+
+    // Applies the fixings to the domains and propagates them. Returns false if they turn out to
+    // be infeasible, in which case the domains must not be used anymore.
+    [[nodiscard]] bool Propagate(
+        std::span<const Variable> fixedVariables0, std::span<const Variable> fixedVariables1);
+
+    [[nodiscard]] bool IsPossible(size_t a, size_t u, size_t v) const;
+    [[nodiscard]] bool IsFixedToOne(size_t a, size_t u, size_t v) const;
+};
+}
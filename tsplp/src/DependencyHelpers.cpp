@@ -28,7 +28,7 @@ xt::xtensor<double, 2> CreateTransitiveDependencies(xt::xtensor<double, 2> weigh
 }
 
 DependencyGraph::DependencyGraph(const xt::xtensor<double, 2>& weights)
-    : m_weights(weights)
+    : m_weights(&weights)
 {
     const auto N = weights.shape(0);
 
@@ -67,6 +67,13 @@ DependencyGraph::DependencyGraph(const xt::xtensor<double, 2>& weights)
     }
 }
 
+DependencyGraph::DependencyGraph(size_t N)
+    : m_node2incomingSpanMap(N, { 0, 0 })
+    , m_node2outgoingSpanMap(N, { 0, 0 })
+    , m_weights(nullptr)
+{
+}
+
 std::span<const size_t> DependencyGraph::GetIncomingSpan(size_t n) const
 {
     const auto [s, t] = m_node2incomingSpanMap[n];
@@ -0,0 +1,197 @@
+#include "HeldKarp.hpp"
+
+#include "DependencyHelpers.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TSPLP_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace tsplp
+{
+namespace
+{
+constexpr auto infinity = std::numeric_limits<double>::infinity();
+
+// The rows of the tables are padded with infinity to a multiple of the widest vector.
+constexpr size_t rowAlignment = 8;
+
+// min over i of costs[i] + weights[i]. The minimum is exact, so the instruction sets only differ
+// in speed.
+double MinPlusScalar(const double* costs, const double* weights, size_t length)
+{
+    auto result = infinity;
+    for (size_t i = 0; i < length; ++i)
+        result = std::min(result, costs[i] + weights[i]);
+
+    return result;
+}
+
+#ifdef TSPLP_X86_KERNELS
+__attribute__((target("avx2"))) double MinPlusAvx2(
+    const double* costs, const double* weights, size_t length)
+{
+    constexpr size_t width = 4;
+
+    auto minima = _mm256_set1_pd(infinity);
+    for (size_t i = 0; i < length; i += width)
+    {
+        minima = _mm256_min_pd(
+            minima, _mm256_add_pd(_mm256_loadu_pd(costs + i), _mm256_loadu_pd(weights + i)));
+    }
+
+    std::array<double, width> lanes {};
+    _mm256_storeu_pd(lanes.data(), minima);
+    return *std::min_element(lanes.begin(), lanes.end());
+}
+
+__attribute__((target("avx512f"))) double MinPlusAvx512(
+    const double* costs, const double* weights, size_t length)
+{
+    constexpr size_t width = 8;
+
+    auto minima = _mm512_set1_pd(infinity);
+    for (size_t i = 0; i < length; i += width)
+    {
+        const auto sums = _mm512_add_pd(_mm512_loadu_pd(costs + i), _mm512_loadu_pd(weights + i));
+        minima = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(sums, minima, _CMP_LT_OQ), minima, sums);
+    }
+
+    std::array<double, width> lanes {};
+    _mm512_storeu_pd(lanes.data(), minima);
+    return *std::min_element(lanes.begin(), lanes.end());
+}
+#endif
+
+double MinPlus(
+    const double* costs, const double* weights, size_t length,
+    [[maybe_unused]] InstructionSet instructionSet)
+{
+    assert(length % rowAlignment == 0);
+
+#ifdef TSPLP_X86_KERNELS
+    if (instructionSet == InstructionSet::Avx512)
+        return MinPlusAvx512(costs, weights, length);
+    if (instructionSet == InstructionSet::Avx2)
+        return MinPlusAvx2(costs, weights, length);
+#endif
+
+    return MinPlusScalar(costs, weights, length);
+}
+}
+
+std::tuple<std::vector<size_t>, double> HeldKarpPath(
+    WeightsView weights, size_t start, size_t end, const DependencyGraph& dependencies,
+    InstructionSet instructionSet)
+{
+    const auto N = weights.N();
+    assert(start != end);
+    assert(N <= MaxHeldKarpN);
+
+    const auto weight
+        = [&](size_t u, size_t v) { return weights(u, v) < 0 ? infinity : weights(u, v); };
+
+    if (N == 2 && weights(start, end) >= 0)
+        return { { start, end }, weights(start, end) };
+
+    std::vector<size_t> freeNodes;
+    for (size_t n = 0; n < N; ++n)
+    {
+        if (n != start && n != end)
+            freeNodes.push_back(n);
+    }
+
+    const auto M = freeNodes.size();
+    const auto rowLength = (M + rowAlignment - 1) / rowAlignment * rowAlignment;
+    const auto fullMask = (std::uint32_t { 1 } << M) - 1;
+
+    // incomingWeights[j * rowLength + i] is the weight of the arc from free node i to j
+    std::vector<double> incomingWeights(M * rowLength, infinity);
+    std::vector<std::uint32_t> predecessorMasks(M, 0);
+    for (size_t j = 0; j < M; ++j)
+    {
+        for (size_t i = 0; i < M; ++i)
+        {
+            if (i != j)
+                incomingWeights[j * rowLength + i] = weight(freeNodes[i], freeNodes[j]);
+        }
+
+        for (const auto p : dependencies.GetIncomingSpan(freeNodes[j]))
+        {
+            if (p == end)
+                predecessorMasks[j] = ~std::uint32_t { 0 };
+            else if (p != start)
+            {
+                const auto i = static_cast<size_t>(
+                    std::find(freeNodes.begin(), freeNodes.end(), p) - freeNodes.begin());
+                predecessorMasks[j] |= std::uint32_t { 1 } << i;
+            }
+        }
+    }
+
+    // costs[mask * rowLength + j] is the length of the shortest path from start through the free
+    // nodes in mask that ends at j
+    std::vector<double> costs((size_t { fullMask } + 1) * rowLength, infinity);
+    for (std::uint32_t mask = 1; mask <= fullMask; ++mask)
+    {
+        for (size_t j = 0; j < M; ++j)
+        {
+            const auto bit = std::uint32_t { 1 } << j;
+            const auto previousMask = mask ^ bit;
+            if ((mask & bit) == 0 || (predecessorMasks[j] & ~previousMask) != 0)
+                continue;
+
+            costs[mask * rowLength + j] = previousMask == 0
+                ? weight(start, freeNodes[j])
+                : MinPlus(
+                    &costs[previousMask * rowLength], &incomingWeights[j * rowLength], rowLength,
+                    instructionSet);
+        }
+    }
+
+    auto length = infinity;
+    auto last = M;
+    for (size_t i = 0; i < M; ++i)
+    {
+        const auto candidate = costs[fullMask * rowLength + i] + weight(freeNodes[i], end);
+        if (candidate < length)
+        {
+            length = candidate;
+            last = i;
+        }
+    }
+
+    if (last == M)
+        return { std::vector<size_t> {}, std::numeric_limits<double>::max() };
+
+    // backwards, the predecessor is the node that attains the minimum
+    std::vector<size_t> path { end };
+    auto mask = fullMask;
+    auto j = last;
+    while (true)
+    {
+        path.push_back(freeNodes[j]);
+        const auto previousMask = mask ^ (std::uint32_t { 1 } << j);
+        if (previousMask == 0)
+            break;
+
+        const auto cost = costs[mask * rowLength + j];
+        size_t i = 0;
+        while (costs[previousMask * rowLength + i] + incomingWeights[j * rowLength + i] != cost)
+            ++i;
+
+        mask = previousMask;
+        j = i;
+    }
+    path.push_back(start);
+
+    std::reverse(path.begin(), path.end());
+    return { std::move(path), length };
+}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "InsertionKernels.hpp"
+#include "WeightsView.hpp"
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+namespace tsplp
+{
+class DependencyGraph;
+
+// The largest N, including start and end, for which HeldKarpPath is used instead of an LP. Its
+// table then needs 8 MB.
+constexpr size_t MaxHeldKarpN = 18;
+
+// Exact Held-Karp dynamic program for a single path from start to end through all other nodes,
+// in O(2^M M^2) time and O(2^M M) memory for the M = N - 2 other nodes. A node can only be
+// appended once all its predecessors in the dependency graph are part of the path, and arcs with
+// negative weights (i.e. reverse arcs of dependencies) are never used. The minimum over the
+// predecessors of each node is vectorized. Returns the path and its length, or an empty path and
+// max() if there is none. start and end must differ, and the instruction set must be supported by
+// the CPU.
+[[nodiscard]] std::tuple<std::vector<size_t>, double> HeldKarpPath(
+    WeightsView weights, size_t start, size_t end, const DependencyGraph& dependencies,
+    InstructionSet instructionSet = GetSupportedInstructionSet());
+}
@@ -1,54 +1,111 @@
 #include "Heuristics.hpp"
 
 #include "DependencyHelpers.hpp"
+#include "InsertionKernels.hpp"
+#include "KdTree.hpp"
+#include "LocalSearch.hpp"
+#include "NeighborLists.hpp"
 #include "TsplpExceptions.hpp"
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/connected_components.hpp>
 #include <boost/graph/topological_sort.hpp>
 #include <boost/range/adaptor/reversed.hpp>
-#include <xtensor/xmanipulation.hpp>
-#include <xtensor/xview.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <thread>
 #include <unordered_set>
 
 namespace tsplp
 {
+namespace
+{
+// Calls evaluate(a, i) for inserting n in front of position i of path a, for all i >= firstPosition
+// and agents in [aRangeFirst, aRangeLast). With neighbor lists, only the positions next to the
+// nearest neighbors of n are evaluated, unless none of these is suitable. Whole paths are evaluated
+// by evaluatePath(a, firstPosition) instead, which has to behave like calling evaluate for each
+// position in order.
+template <typename Evaluate, typename EvaluatePath>
+void EvaluateInsertionPositions(
+    size_t n, const std::vector<std::vector<size_t>>& paths, size_t aRangeFirst, size_t aRangeLast,
+    size_t firstPosition, const std::vector<size_t>& node2Agent,
+    const std::vector<size_t>& node2Position, const NeighborLists* neighborLists,
+    Evaluate&& evaluate, EvaluatePath&& evaluatePath)
+{
+    if (neighborLists != nullptr)
+    {
+        std::vector<std::pair<size_t, size_t>> positions;
+        const auto addPosition = [&](size_t a, size_t i)
+        {
+            if (aRangeFirst <= a && a < aRangeLast && firstPosition <= i && i < paths[a].size())
+                positions.emplace_back(a, i);
+        };
+
+        for (const auto c : neighborLists->GetIncomingSpan(n))
+            addPosition(node2Agent[c], node2Position[c] + 1);
+
+        for (const auto d : neighborLists->GetOutgoingSpan(n))
+            addPosition(node2Agent[d], node2Position[d]);
+
+        // same order as below, so ties are broken the same way
+        std::sort(positions.begin(), positions.end());
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+        for (const auto& [a, i] : positions)
+            evaluate(a, i);
+
+        if (!positions.empty())
+            return;
+    }
+
+    for (size_t a = aRangeFirst; a < aRangeLast; ++a)
+        evaluatePath(a, firstPosition);
+}
+
+void UpdatePositions(
+    const std::vector<size_t>& path, size_t a, size_t first, std::vector<size_t>& node2Agent,
+    std::vector<size_t>& node2Position)
+{
+    for (auto i = first; i < path.size(); ++i)
+    {
+        node2Agent[path[i]] = a;
+        node2Position[path[i]] = i;
+    }
+}
+}
 
 std::vector<std::vector<size_t>> ExploitFractionalSolution(
-    OptimizationMode optimizationMode, xt::xarray<double> fractionalSolution,
-    xt::xarray<double> weights, const xt::xtensor<size_t, 1>& startPositions,
+    OptimizationMode optimizationMode, const xt::xtensor<double, 3>& fractionalSolution,
+    WeightsView weights, const xt::xtensor<size_t, 1>& startPositions,
     const xt::xtensor<size_t, 1>& endPositions, const DependencyGraph& dependencies,
     std::chrono::steady_clock::time_point endTime)
 {
-    const auto A = startPositions.size();
-    assert(endPositions.size() == A);
-
-    if (weights.dimension() == 2)
-        weights = xt::repeat(xt::view(weights, xt::newaxis(), xt::all()), A, 0);
+    assert(fractionalSolution.shape(0) == startPositions.size());
 
-    const auto [heuristicPaths, _] = NearestInsertion(
-        optimizationMode, (1.0 - fractionalSolution) * weights, startPositions, endPositions,
-        dependencies, endTime);
+    const auto [heuristicPaths, _] = CheapestInsertion(
+        optimizationMode, AgentWeights { weights, fractionalSolution }, startPositions,
+        endPositions, dependencies, endTime);
 
     return heuristicPaths;
 }
 
 std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertionSum(
-    xt::xarray<double> weights, const xt::xtensor<size_t, 1>& startPositions,
+    const AgentWeights& weights, const xt::xtensor<size_t, 1>& startPositions,
     const xt::xtensor<size_t, 1>& endPositions, const DependencyGraph& dependencies,
-    std::chrono::steady_clock::time_point endTime)
+    std::chrono::steady_clock::time_point endTime, const NeighborLists* neighborLists)
 {
     const auto A = startPositions.size();
     assert(endPositions.size() == A);
 
-    if (weights.dimension() == 2)
-        weights = xt::repeat(xt::view(weights, xt::newaxis(), xt::all()), A, 0);
-
-    assert(weights.dimension() == 3);
-
-    const auto N = weights.shape(1);
-    assert(weights.shape(2) == N);
+    const auto N = weights.N();
 
     boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS> dependencyGraph(N);
     boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS> dependencyGraphUndirected(
@@ -77,6 +134,8 @@ std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertionSum(
     std::vector<size_t> component2AgentMap(numberOfComponents, A);
 
     auto paths = std::vector<std::vector<size_t>>(A);
+    std::vector<size_t> node2Agent(N, A);
+    std::vector<size_t> node2Position(N, 0);
     double objective = 0;
     for (size_t a = 0; a < A; ++a)
     {
@@ -84,6 +143,7 @@ std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertionSum(
 
         paths[a].push_back(startPositions[a]);
         paths[a].push_back(endPositions[a]);
+        UpdatePositions(paths[a], a, 0, node2Agent, node2Position);
 
         objective += weights(a, startPositions[a], endPositions[a]);
 
@@ -114,25 +174,39 @@ std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertionSum(
             ? std::make_pair(static_cast<size_t>(0), A)
             : std::make_pair(component2AgentMap[comp], component2AgentMap[comp] + 1);
 
-        for (size_t a = aRangeFirst; a < aRangeLast; ++a)
+        const auto evaluate = [&](size_t a, size_t i)
         {
-            for (size_t i = 1 + lastInsertPositionOfComponent[comp]; i < paths[a].size(); ++i)
+            const auto oldCost = weights(a, paths[a][i - 1], paths[a][i]);
+            const auto newCost = weights(a, paths[a][i - 1], n) + weights(a, n, paths[a][i]);
+            const auto deltaCost = newCost - oldCost;
+            if (deltaCost < minDeltaCost)
             {
-                const auto oldCost = weights(a, paths[a][i - 1], paths[a][i]);
-                const auto newCost = weights(a, paths[a][i - 1], n) + weights(a, n, paths[a][i]);
-                const auto deltaCost = newCost - oldCost;
-                if (deltaCost < minDeltaCost)
-                {
-                    minDeltaCost = deltaCost;
-                    minA = a;
-                    minI = i;
-                }
+                minDeltaCost = deltaCost;
+                minA = a;
+                minI = i;
             }
-        }
+        };
+
+        const auto evaluatePath = [&](size_t a, size_t first)
+        {
+            const auto [deltaCost, i]
+                = FindCheapestInsertionPosition(weights, a, paths[a], first, n);
+            if (deltaCost < minDeltaCost)
+            {
+                minDeltaCost = deltaCost;
+                minA = a;
+                minI = i;
+            }
+        };
+
+        EvaluateInsertionPositions(
+            n, paths, aRangeFirst, aRangeLast, 1 + lastInsertPositionOfComponent[comp],
+            node2Agent, node2Position, neighborLists, evaluate, evaluatePath);
 
         using DiffT = decltype(paths[minA].begin())::difference_type;
         paths[minA].insert(paths[minA].begin() + static_cast<DiffT>(minI), n);
         objective += minDeltaCost;
+        UpdatePositions(paths[minA], minA, minI, node2Agent, node2Position);
 
         component2AgentMap[comp] = minA;
         lastInsertPositionOfComponent[comp] = minI;
@@ -142,20 +216,14 @@ std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertionSum(
 }
 
 std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertionMax(
-    xt::xarray<double> weights, const xt::xtensor<size_t, 1>& startPositions,
+    const AgentWeights& weights, const xt::xtensor<size_t, 1>& startPositions,
     const xt::xtensor<size_t, 1>& endPositions, const DependencyGraph& dependencies,
-    std::chrono::steady_clock::time_point endTime)
+    std::chrono::steady_clock::time_point endTime, const NeighborLists* neighborLists)
 {
     const auto A = startPositions.size();
     assert(endPositions.size() == A);
 
-    if (weights.dimension() == 2)
-        weights = xt::repeat(xt::view(weights, xt::newaxis(), xt::all()), A, 0);
-
-    assert(weights.dimension() == 3);
-
-    const auto N = weights.shape(1);
-    assert(weights.shape(2) == N);
+    const auto N = weights.N();
 
     boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS> dependencyGraph(N);
     boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS> dependencyGraphUndirected(
@@ -186,6 +254,8 @@ std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertionMax(
 
     auto paths = std::vector<std::vector<size_t>>(A);
     auto pathLengths = std::vector<double>(A);
+    std::vector<size_t> node2Agent(N, A);
+    std::vector<size_t> node2Position(N, 0);
     size_t longestA = 0;
     for (size_t a = 0; a < A; ++a)
     {
@@ -193,6 +263,7 @@ std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertionMax(
 
         paths[a].push_back(startPositions[a]);
         paths[a].push_back(endPositions[a]);
+        UpdatePositions(paths[a], a, 0, node2Agent, node2Position);
 
         pathLengths[a] = weights(a, startPositions[a], endPositions[a]);
         if (pathLengths[a] > pathLengths[longestA])
@@ -227,62 +298,70 @@ std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertionMax(
             ? std::make_pair(static_cast<size_t>(0), A)
             : std::make_pair(component2AgentMap[comp], component2AgentMap[comp] + 1);
 
-        for (size_t a = aRangeFirst; a < aRangeLast; ++a)
+        const auto evaluate = [&](size_t a, size_t i)
         {
-            for (size_t i = 1 + lastInsertPositionOfComponent[comp]; i < paths[a].size(); ++i)
-            {
-                const auto oldCost = weights(a, paths[a][i - 1], paths[a][i]);
-                const auto newCost = weights(a, paths[a][i - 1], n) + weights(a, n, paths[a][i]);
-                const auto potentialPathLength = newCost - oldCost + pathLengths[a];
+            const auto oldCost = weights(a, paths[a][i - 1], paths[a][i]);
+            const auto newCost = weights(a, paths[a][i - 1], n) + weights(a, n, paths[a][i]);
+            const auto potentialPathLength = newCost - oldCost + pathLengths[a];
 
-                // This is a special case where the objective value becomes smaller by inserting a
-                // node. We need to figure out which path is now the longest.
-                if (a == longestA && newCost < oldCost)
+            // This is a special case where the objective value becomes smaller by inserting a
+            // node. We need to figure out which path is now the longest.
+            if (a == longestA && newCost < oldCost)
+            {
+                auto potentialObjective = potentialPathLength;
+                auto potentiallyLongestA = longestA;
+                for (size_t aa = 0; aa < A; ++aa)
                 {
-                    auto potentialObjective = potentialPathLength;
-                    auto potentiallyLongestA = longestA;
-                    for (size_t aa = 0; aa < A; ++aa)
-                    {
-                        if (aa == longestA)
-                            continue;
-
-                        if (pathLengths[aa] > potentialObjective)
-                        {
-                            potentialObjective = pathLengths[aa];
-                            potentiallyLongestA = aa;
-                        }
-                    }
+                    if (aa == longestA)
+                        continue;
 
-                    const auto costIncrease = potentialObjective - pathLengths[longestA];
-                    if (costIncrease < minCostIncrease)
+                    if (pathLengths[aa] > potentialObjective)
                     {
-                        minCostIncrease = costIncrease;
-                        minAPathLength = potentialPathLength;
-                        minA = a;
-                        minI = i;
-                        newLongestA = potentiallyLongestA;
+                        potentialObjective = pathLengths[aa];
+                        potentiallyLongestA = aa;
                     }
                 }
-                else
+
+                const auto costIncrease = potentialObjective - pathLengths[longestA];
+                if (costIncrease < minCostIncrease)
                 {
-                    const auto costIncrease
-                        = std::max(potentialPathLength - pathLengths[longestA], 0.0);
-                    if (costIncrease < minCostIncrease)
-                    {
-                        minCostIncrease = costIncrease;
-                        minAPathLength = potentialPathLength;
-                        minA = a;
-                        minI = i;
-                        newLongestA = costIncrease > 0 ? a : longestA;
-                    }
+                    minCostIncrease = costIncrease;
+                    minAPathLength = potentialPathLength;
+                    minA = a;
+                    minI = i;
+                    newLongestA = potentiallyLongestA;
                 }
             }
-        }
+            else
+            {
+                const auto costIncrease
+                    = std::max(potentialPathLength - pathLengths[longestA], 0.0);
+                if (costIncrease < minCostIncrease)
+                {
+                    minCostIncrease = costIncrease;
+                    minAPathLength = potentialPathLength;
+                    minA = a;
+                    minI = i;
+                    newLongestA = costIncrease > 0 ? a : longestA;
+                }
+            }
+        };
+
+        const auto evaluatePath = [&](size_t a, size_t first)
+        {
+            for (auto i = first; i < paths[a].size(); ++i)
+                evaluate(a, i);
+        };
+
+        EvaluateInsertionPositions(
+            n, paths, aRangeFirst, aRangeLast, 1 + lastInsertPositionOfComponent[comp],
+            node2Agent, node2Position, neighborLists, evaluate, evaluatePath);
 
         using DiffT = decltype(paths[minA].begin())::difference_type;
         paths[minA].insert(paths[minA].begin() + static_cast<DiffT>(minI), n);
         assert(newLongestA < A);
         pathLengths[minA] = minAPathLength;
+        UpdatePositions(paths[minA], minA, minI, node2Agent, node2Position);
         longestA = newLongestA;
 
         component2AgentMap[comp] = minA;
@@ -293,186 +372,1263 @@ std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertionMax(
 }
 
 std::tuple<std::vector<std::vector<size_t>>, double> NearestInsertion(
-    OptimizationMode optimizationMode, xt::xarray<double> weights,
+    OptimizationMode optimizationMode, const AgentWeights& weights,
     const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
-    const DependencyGraph& dependencies, std::chrono::steady_clock::time_point endTime)
+    const DependencyGraph& dependencies, std::chrono::steady_clock::time_point endTime,
+    const NeighborLists* neighborLists)
 {
     switch (optimizationMode)
     {
     case OptimizationMode::Max:
-        return NearestInsertionMax(weights, startPositions, endPositions, dependencies, endTime);
+        return NearestInsertionMax(
+            weights, startPositions, endPositions, dependencies, endTime, neighborLists);
     case OptimizationMode::Sum:
-        return NearestInsertionSum(weights, startPositions, endPositions, dependencies, endTime);
+        return NearestInsertionSum(
+            weights, startPositions, endPositions, dependencies, endTime, neighborLists);
     default:
         throw TsplpException();
     }
 }
 
-class PathsInfo
+namespace
 {
-    OptimizationMode m_optimizationMode;
-    size_t m_longestA = 0;
-    std::vector<double> m_pathLengths;
+// The optimization mode is a template parameter, so choosing the path of each insertion does not
+// branch on it.
+template <OptimizationMode mode>
+std::tuple<std::vector<std::vector<size_t>>, double> CheapestInsertionForMode(
+    const AgentWeights& weights, const xt::xtensor<size_t, 1>& startPositions,
+    const xt::xtensor<size_t, 1>& endPositions, const DependencyGraph& dependencies,
+    std::chrono::steady_clock::time_point endTime)
+{
+    const auto A = startPositions.size();
+    assert(endPositions.size() == A);
 
-public:
-    PathsInfo(
-        OptimizationMode optimizationMode, const std::vector<std::vector<size_t>>& paths,
-        const xt::xarray<double> weights)
-        : m_optimizationMode(optimizationMode)
+    const auto N = weights.N();
+
+    boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS> dependencyGraphUndirected(
+        N);
+    for (const auto& [u, v] : dependencies.GetArcs())
+        add_edge(u, v, dependencyGraphUndirected);
+
+    for (size_t a = 0; a < A; ++a)
+        add_edge(startPositions[a], endPositions[a], dependencyGraphUndirected);
+
+    std::vector<size_t> componentIds(N);
+    const auto numberOfComponents
+        = boost::connected_components(dependencyGraphUndirected, componentIds.data());
+
+    std::vector<size_t> component2AgentMap(numberOfComponents, A);
+
+    auto paths = std::vector<std::vector<size_t>>(A);
+    auto pathLengths = std::vector<double>(A);
+    std::vector<size_t> node2Agent(N, A);
+    std::vector<size_t> node2Position(N, 0);
+    for (size_t a = 0; a < A; ++a)
     {
-        const auto A = paths.size();
-        m_pathLengths.resize(A);
-        if (m_optimizationMode == OptimizationMode::Max)
-        {
-            for (size_t a = 0; a < A; ++a)
-            {
-                m_pathLengths[a] = CalculatePathLength(paths[a], weights);
+        assert(componentIds[startPositions[a]] == componentIds[endPositions[a]]);
 
-                if (m_pathLengths[a] > m_pathLengths[m_longestA])
-                    m_longestA = a;
-            }
-        }
+        paths[a].push_back(startPositions[a]);
+        paths[a].push_back(endPositions[a]);
+        UpdatePositions(paths[a], a, 0, node2Agent, node2Position);
+        pathLengths[a] = weights(a, startPositions[a], endPositions[a]);
+
+        if (component2AgentMap[componentIds[startPositions[a]]] != A)
+            throw IncompatibleDependenciesException();
+
+        component2AgentMap[componentIds[startPositions[a]]] = a;
     }
 
-    [[nodiscard]] std::array<size_t, 2> GetA2Range(size_t a1) const
+    // Cheapest insertion of a node into a path, behind the node After. Once this slot is gone, its
+    // Delta still is a lower bound for all other slots of the path, which are only evaluated again
+    // when the node is about to be inserted.
+    struct Slot
     {
-        switch (m_optimizationMode)
-        {
-        case OptimizationMode::Sum:
-            return { a1, m_pathLengths.size() };
-        case OptimizationMode::Max:
-            if (a1 < m_longestA)
-                return { m_longestA, m_longestA + 1 };
-            if (a1 == m_longestA)
-                return { m_longestA, m_pathLengths.size() };
-            if (a1 > m_longestA)
-                return { 0, 0 };
-        }
+        double Delta = std::numeric_limits<double>::max();
+        size_t After = std::numeric_limits<size_t>::max();
+        bool IsLowerBound = false;
+    };
 
-        return { 0, 0 };
-    }
+    std::vector<Slot> bestSlots(N * A);
+    std::vector<double> keys(N, std::numeric_limits<double>::max());
 
-    [[nodiscard]] double CalculateOverallImprovement(
-        size_t a1, double improvementA1, size_t a2, double improvementA2) const
+    // entries are outdated if the key of the node has changed in the meantime
+    using QueueEntry = std::pair<double, size_t>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+
+    // nodes whose predecessors are all inserted already
+    std::vector<size_t> candidates;
+    std::vector<size_t> missingPredecessors(N, 0);
+
+    const auto isAllowed = [&](size_t n, size_t a)
     {
-        if (m_optimizationMode == OptimizationMode::Sum)
-            return improvementA1 + improvementA2;
+        const auto agent = component2AgentMap[componentIds[n]];
+        return agent == A || agent == a;
+    };
 
-        const auto oldObjective = m_pathLengths[m_longestA];
-        double newObjective = 0.0;
-        for (size_t a = 0; a < m_pathLengths.size(); ++a)
-        {
-            auto aLength = m_pathLengths[a];
-            if (a == a1)
-                aLength -= improvementA1;
-            if (a == a2)
-                aLength -= improvementA2;
+    // all predecessors are in the same path as n will be
+    const auto getFirstPosition = [&](size_t n)
+    {
+        size_t first = 1;
+        for (const auto p : dependencies.GetIncomingSpan(n))
+            first = std::max(first, node2Position[p] + 1);
+        return first;
+    };
 
-            if (aLength > newObjective)
-                newObjective = aLength;
+    const auto evaluateSlot = [&](size_t n, size_t a, size_t u, size_t v)
+    {
+        auto& slot = bestSlots[n * A + a];
+        const auto delta = weights(a, u, n) + weights(a, n, v) - weights(a, u, v);
+        if (delta < slot.Delta)
+            slot = { delta, u };
+    };
+
+    const auto evaluatePath = [&](size_t n, size_t a)
+    {
+        bestSlots[n * A + a] = {};
+        if (!isAllowed(n, a))
+            return;
+
+        const auto& path = paths[a];
+        const auto [delta, i]
+            = FindCheapestInsertionPosition(weights, a, path, getFirstPosition(n), n);
+        if (i < path.size())
+            bestSlots[n * A + a] = { delta, path[i - 1] };
+    };
+
+    const auto updateKey = [&](size_t n)
+    {
+        auto key = std::numeric_limits<double>::max();
+        for (size_t a = 0; a < A; ++a)
+        {
+            if (isAllowed(n, a))
+                key = std::min(key, bestSlots[n * A + a].Delta);
         }
 
-        return oldObjective - newObjective;
-    }
+        if (key != keys[n])
+        {
+            keys[n] = key;
+            queue.emplace(key, n);
+        }
+    };
 
-    void ApplyImprovement(size_t a1, double improvementA1, size_t a2, double improvementA2)
+    size_t remaining = 0;
+    for (size_t n = 0; n < N; ++n)
     {
-        if (m_optimizationMode == OptimizationMode::Sum)
-            return;
+        if (node2Agent[n] != A)
+            continue;
 
-        m_pathLengths[a1] -= improvementA1;
-        m_pathLengths[a2] -= improvementA2;
-        m_longestA = 0;
-        for (size_t a = 1; a < m_pathLengths.size(); ++a)
+        ++remaining;
+        for (const auto p : dependencies.GetIncomingSpan(n))
         {
-            if (m_pathLengths[a] > m_pathLengths[m_longestA])
-                m_longestA = a;
+            if (node2Agent[p] == A)
+                ++missingPredecessors[n];
+        }
+
+        if (missingPredecessors[n] == 0)
+        {
+            candidates.push_back(n);
+            for (size_t a = 0; a < A; ++a)
+                evaluatePath(n, a);
+            updateKey(n);
         }
     }
-};
 
-std::tuple<std::vector<std::vector<size_t>>, double> TwoOptPaths(
-    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths,
-    xt::xarray<double> weights, const DependencyGraph& dependencies,
-    std::chrono::steady_clock::time_point endTime)
-{
-    assert(weights.dimension() == 2);
+    while (remaining > 0)
+    {
+        if (std::chrono::steady_clock::now() >= endTime)
+            return { std::vector<std::vector<size_t>> {}, 0 };
 
-    const auto A = paths.size();
-    assert(A > 0);
+        assert(!queue.empty());
+        const auto [key, n] = queue.top();
+        queue.pop();
 
-    PathsInfo pathsInfo(optimizationMode, paths, weights);
+        if (node2Agent[n] != A || key != keys[n])
+            continue;
 
-    bool hasImproved = true;
-    double improvementSum = 0.0;
+        bool hasLowerBounds = false;
+        for (size_t a = 0; a < A; ++a)
+        {
+            if (isAllowed(n, a) && bestSlots[n * A + a].IsLowerBound)
+            {
+                evaluatePath(n, a);
+                hasLowerBounds = true;
+            }
+        }
 
-    while (hasImproved && std::chrono::steady_clock::now() < endTime)
-    {
-        hasImproved = false;
+        // insert n later if its actual insertion costs are higher than the lower bound
+        if (hasLowerBounds)
+        {
+            updateKey(n);
+            if (keys[n] != key)
+                continue;
+        }
 
-        for (size_t a1 = 0; a1 < A; ++a1)
+        size_t minA = A;
+        if constexpr (mode == OptimizationMode::Sum)
         {
-            const auto [a2Start, a2End] = pathsInfo.GetA2Range(a1);
-            for (size_t a2 = a2Start; a2 < a2End; ++a2)
+            for (size_t a = 0; a < A; ++a)
             {
-                for (size_t i = 1; i < paths[a1].size() - 1; ++i)
+                if (isAllowed(n, a) && bestSlots[n * A + a].Delta == key)
                 {
-                    const auto u = paths[a1][i];
-                    if (a1 != a2
-                        && (!dependencies.GetIncomingSpan(u).empty()
-                            || !dependencies.GetOutgoingSpan(u).empty()))
-                        continue;
+                    minA = a;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            // insert where the objective grows least, then where the insertion is cheapest
+            auto longest = std::numeric_limits<double>::lowest();
+            auto secondLongest = std::numeric_limits<double>::lowest();
+            size_t longestA = A;
+            for (size_t a = 0; a < A; ++a)
+            {
+                if (pathLengths[a] > longest)
+                {
+                    secondLongest = longest;
+                    longest = pathLengths[a];
+                    longestA = a;
+                }
+                else
+                {
+                    secondLongest = std::max(secondLongest, pathLengths[a]);
+                }
+            }
 
-                    const auto jStart = a1 == a2 ? i + 1 : static_cast<size_t>(1);
-                    // TODO: Consider involving start and end nodes here unless enforced by
-                    // dependencies
-                    for (size_t j = jStart; j < paths[a2].size() - 1; ++j)
-                    {
-                        const auto v = paths[a2][j];
+            auto minObjective = std::numeric_limits<double>::max();
+            for (size_t a = 0; a < A; ++a)
+            {
+                const auto delta = bestSlots[n * A + a].Delta;
+                if (!isAllowed(n, a) || delta == std::numeric_limits<double>::max())
+                    continue;
+
+                const auto objective
+                    = std::max(pathLengths[a] + delta, a == longestA ? secondLongest : longest);
+                if (objective < minObjective
+                    || (objective == minObjective && minA < A
+                        && delta < bestSlots[n * A + minA].Delta))
+                {
+                    minObjective = objective;
+                    minA = a;
+                }
+            }
+        }
 
-                        if (!dependencies.IsEmpty())
-                        {
-                            if (a1 != a2
-                                && (!dependencies.GetIncomingSpan(v).empty()
-                                    || !dependencies.GetOutgoingSpan(v).empty()))
-                                continue;
+        assert(minA < A);
+        const auto slot = bestSlots[n * A + minA];
+        auto& path = paths[minA];
+        const auto i = node2Position[slot.After] + 1;
 
-                            if (a1 == a2)
-                            {
-                                bool wouldBreakDependency = false;
-                                for (auto k = i; k < j; ++k)
-                                {
-                                    if (dependencies.HasArc(u, paths[a1][k + 1])
-                                        || dependencies.HasArc(paths[a1][k], v))
-                                    {
-                                        wouldBreakDependency = true;
-                                        break;
-                                    }
-                                }
+        using DiffT = decltype(path.begin())::difference_type;
+        path.insert(path.begin() + static_cast<DiffT>(i), n);
+        pathLengths[minA] += slot.Delta;
+        UpdatePositions(path, minA, i, node2Agent, node2Position);
+        component2AgentMap[componentIds[n]] = minA;
+        --remaining;
 
-                                if (wouldBreakDependency)
-                                    continue;
-                            }
-                        }
+        candidates.erase(std::find(candidates.begin(), candidates.end(), n));
 
-                        double improvementA1 = 0.0;
-                        double improvementA2 = 0.0;
+        for (const auto s : dependencies.GetOutgoingSpan(n))
+        {
+            if (--missingPredecessors[s] == 0)
+            {
+                candidates.push_back(s);
+                for (size_t a = 0; a < A; ++a)
+                    evaluatePath(s, a);
+            }
+        }
 
-                        if (a1 == a2 && j == i + 1)
-                        {
-                            // clang-format off
-                            const auto before1 = weights(paths[a1][i - 1], paths[a1][i    ]);
-                            const auto before2 = weights(paths[a1][i    ], paths[a1][i + 1]);
-                            const auto before4 = weights(paths[a1][i + 1], paths[a1][i + 2]);
-                            const auto after1  = weights(paths[a1][i - 1], paths[a1][i + 1]);
-                            const auto after2  = weights(paths[a1][i + 1], paths[a1][i    ]);
-                            const auto after4  = weights(paths[a1][i    ], paths[a1][i + 2]);
-                            improvementA1 = before1 + before2 + before4 - after1 - after2 - after4;
-                            // clang-format on
-                        }
-                        else
-                        {
-                            // clang-format off
+        // Only the slots of path minA around n have changed.
+        const auto u = path[i - 1];
+        const auto v = path[i + 1];
+        for (const auto c : candidates)
+        {
+            auto& candidateSlot = bestSlots[c * A + minA];
+            if (!isAllowed(c, minA))
+            {
+                candidateSlot = {};
+            }
+            else
+            {
+                if (candidateSlot.After == u)
+                    candidateSlot.IsLowerBound = true;
+
+                const auto first = getFirstPosition(c);
+                if (i >= first)
+                    evaluateSlot(c, minA, u, n);
+                if (i + 1 >= first)
+                    evaluateSlot(c, minA, n, v);
+            }
+
+            updateKey(c);
+        }
+    }
+
+    double objective = 0.0;
+    for (const auto length : pathLengths)
+    {
+        if constexpr (mode == OptimizationMode::Sum)
+            objective += length;
+        else
+            objective = std::max(objective, length);
+    }
+
+    return { paths, objective };
+}
+}
+
+std::tuple<std::vector<std::vector<size_t>>, double> CheapestInsertion(
+    OptimizationMode optimizationMode, const AgentWeights& weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
+    const DependencyGraph& dependencies, std::chrono::steady_clock::time_point endTime)
+{
+    switch (optimizationMode)
+    {
+    case OptimizationMode::Max:
+        return CheapestInsertionForMode<OptimizationMode::Max>(
+            weights, startPositions, endPositions, dependencies, endTime);
+    case OptimizationMode::Sum:
+        return CheapestInsertionForMode<OptimizationMode::Sum>(
+            weights, startPositions, endPositions, dependencies, endTime);
+    default:
+        throw TsplpException();
+    }
+}
+
+namespace
+{
+// Ids of the connected components of the undirected dependency graph, where each start node is
+// connected to its end node. All nodes of a component have to be visited by the same agent.
+std::vector<size_t> CalculateDependencyComponents(
+    size_t N, const xt::xtensor<size_t, 1>& startPositions,
+    const xt::xtensor<size_t, 1>& endPositions, const DependencyGraph& dependencies)
+{
+    boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS> dependencyGraphUndirected(
+        N);
+    for (const auto& [u, v] : dependencies.GetArcs())
+        add_edge(u, v, dependencyGraphUndirected);
+
+    for (size_t a = 0; a < startPositions.size(); ++a)
+        add_edge(startPositions[a], endPositions[a], dependencyGraphUndirected);
+
+    std::vector<size_t> componentIds(N);
+    boost::connected_components(dependencyGraphUndirected, componentIds.data());
+
+    return componentIds;
+}
+
+// Inserts all nodes that are not part of the paths, in the order given by the criterion, each at
+// its cheapest position. The paths have to respect the dependencies, so each node is inserted
+// behind its predecessors and in front of its successors.
+std::tuple<std::vector<std::vector<size_t>>, double> InsertMissingNodes(
+    OptimizationMode optimizationMode, const AgentWeights& weights,
+    std::vector<std::vector<size_t>> paths, const DependencyGraph& dependencies,
+    std::span<const size_t> componentIds, InsertionCriterion criterion,
+    std::mt19937_64& generator, double noise, std::chrono::steady_clock::time_point endTime)
+{
+    const auto A = paths.size();
+    const auto N = weights.N();
+
+    std::vector<size_t> component2AgentMap(N, A);
+    auto pathLengths = std::vector<double>(A, 0.0);
+    std::vector<size_t> node2Agent(N, A);
+    std::vector<size_t> node2Position(N, 0);
+    for (size_t a = 0; a < A; ++a)
+    {
+        UpdatePositions(paths[a], a, 0, node2Agent, node2Position);
+        for (size_t i = 0; i < paths[a].size(); ++i)
+        {
+            component2AgentMap[componentIds[paths[a][i]]] = a;
+            if (i > 0)
+                pathLengths[a] += weights(a, paths[a][i - 1], paths[a][i]);
+        }
+    }
+
+    // each node keeps its random factor, so its key is only scaled, not reshuffled in every step
+    std::uniform_real_distribution<double> distribution(1.0, 1.0 + noise);
+    std::vector<double> factors(N);
+    for (auto& factor : factors)
+        factor = distribution(generator);
+
+    // cheapest insertion of a node into a path, behind the node After
+    struct Slot
+    {
+        double Delta = std::numeric_limits<double>::max();
+        size_t After = std::numeric_limits<size_t>::max();
+    };
+
+    std::vector<Slot> bestSlots(N * A);
+
+    // nodes whose predecessors are all inserted already
+    std::vector<size_t> candidates;
+    std::vector<size_t> missingPredecessors(N, 0);
+
+    const auto isAllowed = [&](size_t n, size_t a)
+    {
+        const auto agent = component2AgentMap[componentIds[n]];
+        return agent == A || agent == a;
+    };
+
+    // all predecessors are in the same path as n will be
+    const auto getFirstPosition = [&](size_t n)
+    {
+        size_t first = 1;
+        for (const auto p : dependencies.GetIncomingSpan(n))
+            first = std::max(first, node2Position[p] + 1);
+        return first;
+    };
+
+    // successors that are still part of a path are in the same path as n will be, otherwise this
+    // is the position of the end node
+    const auto getLastPosition = [&](size_t n, size_t a)
+    {
+        auto last = paths[a].size() - 1;
+        for (const auto s : dependencies.GetOutgoingSpan(n))
+        {
+            if (node2Agent[s] == a)
+                last = std::min(last, node2Position[s]);
+        }
+        return last;
+    };
+
+    const auto evaluateSlot = [&](size_t n, size_t a, size_t u, size_t v)
+    {
+        auto& slot = bestSlots[n * A + a];
+        const auto delta = weights(a, u, n) + weights(a, n, v) - weights(a, u, v);
+        if (delta < slot.Delta)
+            slot = { delta, u };
+    };
+
+    const auto evaluatePath = [&](size_t n, size_t a)
+    {
+        bestSlots[n * A + a] = {};
+        if (!isAllowed(n, a))
+            return;
+
+        const auto path = std::span<const size_t>(paths[a]).first(getLastPosition(n, a) + 1);
+        const auto [delta, i]
+            = FindCheapestInsertionPosition(weights, a, path, getFirstPosition(n), n);
+        if (i < path.size())
+            bestSlots[n * A + a] = { delta, path[i - 1] };
+    };
+
+    // the costs of inserting n into the path of agent a, in terms of the objective
+    const auto getCosts = [&](size_t n, size_t a)
+    {
+        const auto delta = bestSlots[n * A + a].Delta;
+        if (!isAllowed(n, a) || delta == std::numeric_limits<double>::max())
+            return std::numeric_limits<double>::max();
+
+        return optimizationMode == OptimizationMode::Sum ? delta : pathLengths[a] + delta;
+    };
+
+    size_t remaining = 0;
+    for (size_t n = 0; n < N; ++n)
+    {
+        if (node2Agent[n] != A)
+            continue;
+
+        ++remaining;
+        for (const auto p : dependencies.GetIncomingSpan(n))
+        {
+            if (node2Agent[p] == A)
+                ++missingPredecessors[n];
+        }
+
+        if (missingPredecessors[n] == 0)
+        {
+            candidates.push_back(n);
+            for (size_t a = 0; a < A; ++a)
+                evaluatePath(n, a);
+        }
+    }
+
+    while (remaining > 0)
+    {
+        if (std::chrono::steady_clock::now() >= endTime)
+            return { std::vector<std::vector<size_t>> {}, 0 };
+
+        assert(!candidates.empty());
+
+        // the candidate with the smallest key and its best agent
+        auto minKey = std::numeric_limits<double>::max();
+        auto minHasSingleOption = false;
+        size_t n = N;
+        size_t minA = A;
+        for (const auto c : candidates)
+        {
+            auto best = std::numeric_limits<double>::max();
+            auto secondBest = std::numeric_limits<double>::max();
+            size_t bestA = A;
+            for (size_t a = 0; a < A; ++a)
+            {
+                const auto costs = getCosts(c, a);
+                if (costs < best)
+                {
+                    secondBest = best;
+                    best = costs;
+                    bestA = a;
+                }
+                else
+                {
+                    secondBest = std::min(secondBest, costs);
+                }
+            }
+
+            if (bestA == A)
+                continue;
+
+            double key = 0.0;
+            auto hasSingleOption = false;
+            switch (criterion)
+            {
+            case InsertionCriterion::Cheapest:
+                key = best;
+                break;
+            case InsertionCriterion::Farthest:
+                key = -best;
+                break;
+            case InsertionCriterion::Regret:
+                // Nodes that fit into a single path only are inserted first, the cheapest one
+                // first, which is plain cheapest insertion for a single agent.
+                hasSingleOption = secondBest == std::numeric_limits<double>::max();
+                key = hasSingleOption ? best : best - secondBest;
+                break;
+            default:
+                throw TsplpException();
+            }
+
+            key *= factors[c];
+            if (n == N || (hasSingleOption && !minHasSingleOption)
+                || (hasSingleOption == minHasSingleOption && key < minKey))
+            {
+                minKey = key;
+                minHasSingleOption = hasSingleOption;
+                n = c;
+                minA = bestA;
+            }
+        }
+
+        assert(n < N && minA < A);
+        const auto slot = bestSlots[n * A + minA];
+        auto& path = paths[minA];
+        const auto i = node2Position[slot.After] + 1;
+
+        using DiffT = decltype(path.begin())::difference_type;
+        path.insert(path.begin() + static_cast<DiffT>(i), n);
+        pathLengths[minA] += slot.Delta;
+        UpdatePositions(path, minA, i, node2Agent, node2Position);
+        component2AgentMap[componentIds[n]] = minA;
+        --remaining;
+
+        candidates.erase(std::find(candidates.begin(), candidates.end(), n));
+
+        // Only the slots of path minA around n have changed.
+        const auto u = path[i - 1];
+        const auto v = path[i + 1];
+        for (const auto c : candidates)
+        {
+            if (bestSlots[c * A + minA].After == u)
+            {
+                evaluatePath(c, minA);
+            }
+            else if (isAllowed(c, minA))
+            {
+                const auto first = getFirstPosition(c);
+                const auto last = getLastPosition(c, minA);
+                if (first <= i && i <= last)
+                    evaluateSlot(c, minA, u, n);
+                if (first <= i + 1 && i + 1 <= last)
+                    evaluateSlot(c, minA, n, v);
+            }
+        }
+
+        for (const auto s : dependencies.GetOutgoingSpan(n))
+        {
+            if (--missingPredecessors[s] == 0)
+            {
+                candidates.push_back(s);
+                for (size_t a = 0; a < A; ++a)
+                    evaluatePath(s, a);
+            }
+        }
+    }
+
+    double objective = 0.0;
+    for (const auto length : pathLengths)
+    {
+        objective = optimizationMode == OptimizationMode::Sum ? objective + length
+                                                              : std::max(objective, length);
+    }
+
+    return { paths, objective };
+}
+}
+
+std::tuple<std::vector<std::vector<size_t>>, double> RandomizedInsertion(
+    OptimizationMode optimizationMode, const AgentWeights& weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
+    const DependencyGraph& dependencies, InsertionCriterion criterion, std::uint64_t seed,
+    double noise, std::chrono::steady_clock::time_point endTime)
+{
+    const auto A = startPositions.size();
+    assert(endPositions.size() == A);
+
+    const auto componentIds
+        = CalculateDependencyComponents(weights.N(), startPositions, endPositions, dependencies);
+
+    std::vector<size_t> component2AgentMap(weights.N(), A);
+    auto paths = std::vector<std::vector<size_t>>(A);
+    for (size_t a = 0; a < A; ++a)
+    {
+        paths[a] = { startPositions[a], endPositions[a] };
+
+        if (component2AgentMap[componentIds[startPositions[a]]] != A)
+            throw IncompatibleDependenciesException();
+
+        component2AgentMap[componentIds[startPositions[a]]] = a;
+    }
+
+    std::mt19937_64 generator(seed);
+    return InsertMissingNodes(
+        optimizationMode, weights, std::move(paths), dependencies, componentIds, criterion,
+        generator, noise, endTime);
+}
+
+std::tuple<std::vector<std::vector<size_t>>, double> SavingsPaths(
+    OptimizationMode optimizationMode, WeightsView weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
+    const NeighborLists& neighborLists, std::uint64_t seed, double noise,
+    std::chrono::steady_clock::time_point endTime)
+{
+    const auto A = startPositions.size();
+    assert(endPositions.size() == A);
+
+    const auto N = weights.N();
+
+    std::vector<bool> isTerminal(N, false);
+    for (size_t a = 0; a < A; ++a)
+    {
+        isTerminal[startPositions[a]] = true;
+        isTerminal[endPositions[a]] = true;
+    }
+
+    // the agents do not share a depot, so savings are relative to the average start and end
+    std::vector<double> toEnd(N, 0.0);
+    std::vector<double> fromStart(N, 0.0);
+    for (size_t n = 0; n < N; ++n)
+    {
+        for (size_t a = 0; a < A; ++a)
+        {
+            toEnd[n] += weights(n, endPositions[a]) / static_cast<double>(A);
+            fromStart[n] += weights(startPositions[a], n) / static_cast<double>(A);
+        }
+    }
+
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<double> distribution(1.0, 1.0 + noise);
+
+    // the savings of the arc (u, v), i.e. of following the chain ending in u by the one starting
+    // in v
+    std::vector<std::tuple<double, size_t, size_t>> savings;
+    for (size_t u = 0; u < N; ++u)
+    {
+        if (isTerminal[u])
+            continue;
+
+        for (const auto v : neighborLists.GetOutgoingSpan(u))
+        {
+            if (isTerminal[v])
+                continue;
+
+            const auto saving = (toEnd[u] + fromStart[v] - weights(u, v)) * distribution(generator);
+            if (saving > 0.0)
+                savings.emplace_back(saving, u, v);
+        }
+    }
+
+    std::sort(savings.begin(), savings.end(), std::greater<> {});
+
+    if (std::chrono::steady_clock::now() >= endTime)
+        return { std::vector<std::vector<size_t>> {}, 0 };
+
+    // chains are only merged at their ends, so the head of a tail and vice versa are enough to
+    // detect cycles
+    std::vector<size_t> successors(N, N);
+    std::vector<size_t> predecessors(N, N);
+    std::vector<size_t> otherEnds(N);
+    std::iota(otherEnds.begin(), otherEnds.end(), 0);
+
+    auto numberOfChains
+        = static_cast<size_t>(std::count(isTerminal.begin(), isTerminal.end(), false));
+    for (const auto& [_, u, v] : savings)
+    {
+        if (numberOfChains <= A)
+            break;
+
+        if (successors[u] != N || predecessors[v] != N || otherEnds[u] == v)
+            continue;
+
+        const auto head = otherEnds[u];
+        const auto tail = otherEnds[v];
+        successors[u] = v;
+        predecessors[v] = u;
+        otherEnds[head] = tail;
+        otherEnds[tail] = head;
+        --numberOfChains;
+    }
+
+    std::vector<std::vector<size_t>> chains;
+    for (size_t n = 0; n < N; ++n)
+    {
+        if (isTerminal[n] || predecessors[n] != N)
+            continue;
+
+        auto& chain = chains.emplace_back();
+        for (auto c = n; c != N; c = successors[c])
+            chain.push_back(c);
+    }
+
+    // the longest chains are appended first, each to the path where this is cheapest
+    std::sort(
+        chains.begin(), chains.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.size() > rhs.size(); });
+
+    std::vector<std::vector<size_t>> paths(A);
+    std::vector<double> pathLengths(A);
+    for (size_t a = 0; a < A; ++a)
+    {
+        paths[a].push_back(startPositions[a]);
+        pathLengths[a] = weights(startPositions[a], endPositions[a]);
+    }
+
+    for (const auto& chain : chains)
+    {
+        const auto chainLength = CalculatePathLength(chain, weights);
+
+        auto minCosts = std::numeric_limits<double>::max();
+        size_t minA = A;
+        for (size_t a = 0; a < A; ++a)
+        {
+            const auto delta = weights(paths[a].back(), chain.front()) + chainLength
+                + weights(chain.back(), endPositions[a])
+                - weights(paths[a].back(), endPositions[a]);
+            const auto costs
+                = optimizationMode == OptimizationMode::Sum ? delta : pathLengths[a] + delta;
+            if (costs < minCosts)
+            {
+                minCosts = costs;
+                minA = a;
+            }
+        }
+
+        assert(minA < A);
+        pathLengths[minA] += weights(paths[minA].back(), chain.front()) + chainLength
+            + weights(chain.back(), endPositions[minA])
+            - weights(paths[minA].back(), endPositions[minA]);
+        paths[minA].insert(paths[minA].end(), chain.begin(), chain.end());
+    }
+
+    for (size_t a = 0; a < A; ++a)
+        paths[a].push_back(endPositions[a]);
+
+    const auto objective = CalculateObjective(optimizationMode, paths, weights);
+    return { std::move(paths), objective };
+}
+
+std::tuple<std::vector<std::vector<size_t>>, double> LargeNeighborhoodSearch(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths, WeightsView weights,
+    const DependencyGraph& dependencies, const NeighborLists& neighborLists,
+    std::chrono::steady_clock::time_point endTime, size_t numberOfThreads, double lowerBound)
+{
+    // the temperature decreases from this fraction of the initial objective to a hundredth of it
+    constexpr double initialTemperatureFactor = 0.01;
+    constexpr double finalTemperatureRatio = 0.01;
+    constexpr double repairNoise = 0.1;
+    constexpr size_t maxRemovedNodes = 50;
+    constexpr size_t synchronizationInterval = 1000;
+
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto A = paths.size();
+    const auto N = weights.N();
+
+    auto startPositions = xt::xtensor<size_t, 1>::from_shape({ A });
+    auto endPositions = xt::xtensor<size_t, 1>::from_shape({ A });
+    std::vector<bool> isTerminal(N, false);
+    for (size_t a = 0; a < A; ++a)
+    {
+        startPositions[a] = paths[a].front();
+        endPositions[a] = paths[a].back();
+        isTerminal[paths[a].front()] = true;
+        isTerminal[paths[a].back()] = true;
+    }
+
+    std::vector<size_t> freeNodes;
+    for (size_t n = 0; n < N; ++n)
+    {
+        if (!isTerminal[n])
+            freeNodes.push_back(n);
+    }
+
+    auto incumbentObjective = CalculateObjective(optimizationMode, paths, weights);
+    if (freeNodes.empty() || incumbentObjective <= lowerBound)
+        return { std::move(paths), incumbentObjective };
+
+    const auto componentIds
+        = CalculateDependencyComponents(N, startPositions, endPositions, dependencies);
+    const auto initialTemperature = initialTemperatureFactor * std::abs(incumbentObjective);
+    const auto maxRemoved = std::min({ freeNodes.size(), std::max<size_t>(freeNodes.size() / 5, 4),
+                                       maxRemovedNodes });
+
+    std::mutex incumbentMutex;
+    auto incumbentPaths = std::move(paths);
+
+    const auto threadLoop = [&](const size_t threadId)
+    {
+        std::mt19937_64 generator(threadId);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+        std::vector<std::vector<size_t>> currentPaths;
+        double currentObjective = 0.0;
+        {
+            std::unique_lock lock { incumbentMutex };
+            currentPaths = incumbentPaths;
+            currentObjective = incumbentObjective;
+        }
+
+        std::vector<bool> isRemoved(N, false);
+        std::vector<size_t> removedNodes;
+
+        for (size_t iteration = 1; std::chrono::steady_clock::now() < endTime; ++iteration)
+        {
+            // continue from the best paths of all threads from time to time
+            if (iteration % synchronizationInterval == 0)
+            {
+                std::unique_lock lock { incumbentMutex };
+                if (incumbentObjective <= lowerBound)
+                    break;
+
+                if (incumbentObjective < currentObjective)
+                {
+                    currentPaths = incumbentPaths;
+                    currentObjective = incumbentObjective;
+                }
+            }
+
+            const auto remove = [&](size_t n)
+            {
+                if (!isTerminal[n] && !isRemoved[n])
+                {
+                    isRemoved[n] = true;
+                    removedNodes.push_back(n);
+                }
+            };
+
+            const auto numberOfRemovedNodes = 1 + generator() % maxRemoved;
+            switch (generator() % 3)
+            {
+            case 0: // random
+                while (removedNodes.size() < numberOfRemovedNodes)
+                    remove(freeNodes[generator() % freeNodes.size()]);
+                break;
+            case 1: // radial, i.e. the neighborhood of a random node
+            {
+                remove(freeNodes[generator() % freeNodes.size()]);
+                for (size_t i = 0;
+                     i < removedNodes.size() && removedNodes.size() < numberOfRemovedNodes; ++i)
+                {
+                    for (const auto v : neighborLists.GetOutgoingSpan(removedNodes[i]))
+                    {
+                        if (removedNodes.size() < numberOfRemovedNodes)
+                            remove(v);
+                    }
+                }
+                break;
+            }
+            case 2: // worst path, i.e. random nodes of the longest path
+            {
+                size_t longestA = 0;
+                auto longest = std::numeric_limits<double>::lowest();
+                for (size_t a = 0; a < A; ++a)
+                {
+                    if (const auto length = CalculatePathLength(currentPaths[a], weights);
+                        length > longest)
+                    {
+                        longest = length;
+                        longestA = a;
+                    }
+                }
+
+                const auto& path = currentPaths[longestA];
+                const auto numberOfInnerNodes = path.size() - 2;
+                for (size_t i = 0; i < std::min(numberOfRemovedNodes, numberOfInnerNodes); ++i)
+                    remove(path[1 + generator() % numberOfInnerNodes]);
+                break;
+            }
+            default:
+                throw TsplpException();
+            }
+
+            auto partialPaths = currentPaths;
+            for (auto& path : partialPaths)
+                std::erase_if(path, [&](size_t n) { return isRemoved[n]; });
+
+            for (const auto n : removedNodes)
+                isRemoved[n] = false;
+            removedNodes.clear();
+
+            auto [repairedPaths, repairedObjective] = InsertMissingNodes(
+                optimizationMode, weights, std::move(partialPaths), dependencies, componentIds,
+                InsertionCriterion::Regret, generator, repairNoise, endTime);
+
+            if (repairedPaths.empty())
+                break;
+
+            // simulated annealing with a temperature that decreases exponentially over time
+            const auto elapsed = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - startTime);
+            const auto fraction = std::min(elapsed / (endTime - startTime), 1.0);
+            const auto temperature
+                = initialTemperature * std::pow(finalTemperatureRatio, fraction);
+
+            if (repairedObjective > currentObjective
+                && uniform(generator)
+                    >= std::exp((currentObjective - repairedObjective) / temperature))
+            {
+                continue;
+            }
+
+            currentPaths = std::move(repairedPaths);
+            currentObjective = repairedObjective;
+
+            std::unique_lock lock { incumbentMutex };
+            if (currentObjective < incumbentObjective)
+            {
+                lock.unlock();
+                auto [improvedPaths, improvement] = LocalSearchPaths(
+                    optimizationMode, std::move(currentPaths), weights, dependencies,
+                    neighborLists, endTime);
+                currentPaths = std::move(improvedPaths);
+                currentObjective -= improvement;
+
+                lock.lock();
+                if (currentObjective < incumbentObjective)
+                {
+                    incumbentPaths = currentPaths;
+                    incumbentObjective = currentObjective;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numberOfThreads; ++t)
+        threads.emplace_back(threadLoop, t);
+
+    threadLoop(0);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    return { std::move(incumbentPaths), incumbentObjective };
+}
+
+std::vector<std::vector<size_t>> BalancedClusters(
+    WeightsView weights, const xt::xtensor<size_t, 1>& startPositions,
+    const xt::xtensor<size_t, 1>& endPositions, const DependencyGraph& dependencies)
+{
+    const auto A = startPositions.size();
+    const auto N = weights.N();
+
+    const auto componentIds
+        = CalculateDependencyComponents(N, startPositions, endPositions, dependencies);
+
+    std::vector<std::vector<size_t>> componentNodes(N);
+    for (size_t n = 0; n < N; ++n)
+        componentNodes[componentIds[n]].push_back(n);
+
+    std::vector<bool> isTerminal(N, false);
+    for (size_t a = 0; a < A; ++a)
+    {
+        isTerminal[startPositions[a]] = true;
+        isTerminal[endPositions[a]] = true;
+    }
+
+    // reverse arcs of dependencies (-1) are never used, so the other direction counts
+    const auto distance = [&](size_t u, size_t v)
+    {
+        if (weights(u, v) == -1)
+            return weights(v, u);
+        if (weights(v, u) == -1)
+            return weights(u, v);
+        return std::min(weights(u, v), weights(v, u));
+    };
+
+    std::vector<std::vector<size_t>> clusters(A);
+    std::vector<bool> isAssigned(N, false);
+
+    // distance of each node to the nearest non-terminal node of each cluster
+    std::vector<std::vector<double>> clusterDistances(
+        A, std::vector<double>(N, std::numeric_limits<double>::max()));
+
+    const auto assignComponent = [&](size_t a, size_t component)
+    {
+        for (const auto n : componentNodes[component])
+        {
+            isAssigned[n] = true;
+            if (isTerminal[n])
+                continue;
+
+            clusters[a].push_back(n);
+            for (size_t m = 0; m < N; ++m)
+                clusterDistances[a][m] = std::min(clusterDistances[a][m], distance(n, m));
+        }
+    };
+
+    for (size_t a = 0; a < A; ++a)
+    {
+        if (isAssigned[startPositions[a]])
+            throw IncompatibleDependenciesException();
+
+        assignComponent(a, componentIds[startPositions[a]]);
+    }
+
+    // Agents that have no nodes yet get the remaining node farthest from all assigned ones as a
+    // seed, so that clusters sharing a depot don't grow around it. Each seed goes to the agent
+    // whose start and end are closest.
+    std::vector<size_t> unseededAgents;
+    for (size_t a = 0; a < A; ++a)
+    {
+        if (clusters[a].empty())
+            unseededAgents.push_back(a);
+    }
+
+    std::vector<double> assignedDistances(N, std::numeric_limits<double>::max());
+    for (size_t n = 0; n < N; ++n)
+    {
+        if (!isAssigned[n])
+            continue;
+
+        for (size_t m = 0; m < N; ++m)
+            assignedDistances[m] = std::min(assignedDistances[m], distance(n, m));
+    }
+
+    while (!unseededAgents.empty())
+    {
+        auto seed = N;
+        for (size_t n = 0; n < N; ++n)
+        {
+            if (!isAssigned[n] && (seed == N || assignedDistances[n] > assignedDistances[seed]))
+                seed = n;
+        }
+
+        if (seed == N)
+            break;
+
+        const auto it = std::min_element(
+            unseededAgents.begin(), unseededAgents.end(),
+            [&](size_t a, size_t b)
+            {
+                return distance(startPositions[a], seed) + distance(seed, endPositions[a])
+                    < distance(startPositions[b], seed) + distance(seed, endPositions[b]);
+            });
+
+        assignComponent(*it, componentIds[seed]);
+        unseededAgents.erase(it);
+
+        for (const auto n : componentNodes[componentIds[seed]])
+        {
+            for (size_t m = 0; m < N; ++m)
+                assignedDistances[m] = std::min(assignedDistances[m], distance(n, m));
+        }
+    }
+
+    // the smallest cluster takes the component of the nearest remaining node, until none is left
+    while (true)
+    {
+        auto a = A;
+        for (size_t b = 0; b < A; ++b)
+        {
+            if (!clusters[b].empty() && (a == A || clusters[b].size() < clusters[a].size()))
+                a = b;
+        }
+
+        auto nearest = N;
+        for (size_t n = 0; a < A && n < N; ++n)
+        {
+            if (!isAssigned[n]
+                && (nearest == N || clusterDistances[a][n] < clusterDistances[a][nearest]))
+            {
+                nearest = n;
+            }
+        }
+
+        if (nearest == N)
+            break;
+
+        assignComponent(a, componentIds[nearest]);
+    }
+
+    return clusters;
+}
+
+template <OptimizationMode mode>
+class PathsInfo
+{
+    size_t m_longestA = 0;
+    std::vector<double> m_pathLengths;
+
+public:
+    PathsInfo(const std::vector<std::vector<size_t>>& paths, WeightsView weights)
+        : m_pathLengths(paths.size())
+    {
+        if constexpr (mode == OptimizationMode::Max)
+        {
+            for (size_t a = 0; a < paths.size(); ++a)
+            {
+                m_pathLengths[a] = CalculatePathLength(paths[a], weights);
+
+                if (m_pathLengths[a] > m_pathLengths[m_longestA])
+                    m_longestA = a;
+            }
+        }
+    }
+
+    [[nodiscard]] std::array<size_t, 2> GetA2Range(size_t a1) const
+    {
+        if constexpr (mode == OptimizationMode::Sum)
+            return { a1, m_pathLengths.size() };
+
+        if (a1 < m_longestA)
+            return { m_longestA, m_longestA + 1 };
+        if (a1 == m_longestA)
+            return { m_longestA, m_pathLengths.size() };
+
+        return { 0, 0 };
+    }
+
+    [[nodiscard]] double CalculateOverallImprovement(
+        size_t a1, double improvementA1, size_t a2, double improvementA2) const
+    {
+        if constexpr (mode == OptimizationMode::Sum)
+            return improvementA1 + improvementA2;
+
+        const auto oldObjective = m_pathLengths[m_longestA];
+        double newObjective = 0.0;
+        for (size_t a = 0; a < m_pathLengths.size(); ++a)
+        {
+            auto aLength = m_pathLengths[a];
+            if (a == a1)
+                aLength -= improvementA1;
+            if (a == a2)
+                aLength -= improvementA2;
+
+            if (aLength > newObjective)
+                newObjective = aLength;
+        }
+
+        return oldObjective - newObjective;
+    }
+
+    void ApplyImprovement(size_t a1, double improvementA1, size_t a2, double improvementA2)
+    {
+        if constexpr (mode == OptimizationMode::Sum)
+            return;
+
+        m_pathLengths[a1] -= improvementA1;
+        m_pathLengths[a2] -= improvementA2;
+        m_longestA = 0;
+        for (size_t a = 1; a < m_pathLengths.size(); ++a)
+        {
+            if (m_pathLengths[a] > m_pathLengths[m_longestA])
+                m_longestA = a;
+        }
+    }
+};
+
+namespace
+{
+// The optimization mode is a template parameter, so the innermost loops do not branch on it.
+template <OptimizationMode mode>
+std::tuple<std::vector<std::vector<size_t>>, double> TwoOptPathsForMode(
+    std::vector<std::vector<size_t>> paths, WeightsView weights,
+    const DependencyGraph& dependencies, std::chrono::steady_clock::time_point endTime)
+{
+    const auto A = paths.size();
+    assert(A > 0);
+
+    PathsInfo<mode> pathsInfo(paths, weights);
+
+    bool hasImproved = true;
+    double improvementSum = 0.0;
+
+    while (hasImproved && std::chrono::steady_clock::now() < endTime)
+    {
+        hasImproved = false;
+
+        for (size_t a1 = 0; a1 < A; ++a1)
+        {
+            const auto [a2Start, a2End] = pathsInfo.GetA2Range(a1);
+            for (size_t a2 = a2Start; a2 < a2End; ++a2)
+            {
+                for (size_t i = 1; i < paths[a1].size() - 1; ++i)
+                {
+                    const auto u = paths[a1][i];
+                    if (a1 != a2
+                        && (!dependencies.GetIncomingSpan(u).empty()
+                            || !dependencies.GetOutgoingSpan(u).empty()))
+                        continue;
+
+                    const auto jStart = a1 == a2 ? i + 1 : static_cast<size_t>(1);
+                    // TODO: Consider involving start and end nodes here unless enforced by
+                    // dependencies
+                    for (size_t j = jStart; j < paths[a2].size() - 1; ++j)
+                    {
+                        const auto v = paths[a2][j];
+
+                        if (!dependencies.IsEmpty())
+                        {
+                            if (a1 != a2
+                                && (!dependencies.GetIncomingSpan(v).empty()
+                                    || !dependencies.GetOutgoingSpan(v).empty()))
+                                continue;
+
+                            if (a1 == a2)
+                            {
+                                bool wouldBreakDependency = false;
+                                for (auto k = i; k < j; ++k)
+                                {
+                                    if (dependencies.HasArc(u, paths[a1][k + 1])
+                                        || dependencies.HasArc(paths[a1][k], v))
+                                    {
+                                        wouldBreakDependency = true;
+                                        break;
+                                    }
+                                }
+
+                                if (wouldBreakDependency)
+                                    continue;
+                            }
+                        }
+
+                        double improvementA1 = 0.0;
+                        double improvementA2 = 0.0;
+
+                        if (a1 == a2 && j == i + 1)
+                        {
+                            // clang-format off
+                            const auto before1 = weights(paths[a1][i - 1], paths[a1][i    ]);
+                            const auto before2 = weights(paths[a1][i    ], paths[a1][i + 1]);
+                            const auto before4 = weights(paths[a1][i + 1], paths[a1][i + 2]);
+                            const auto after1  = weights(paths[a1][i - 1], paths[a1][i + 1]);
+                            const auto after2  = weights(paths[a1][i + 1], paths[a1][i    ]);
+                            const auto after4  = weights(paths[a1][i    ], paths[a1][i + 2]);
+                            improvementA1 = before1 + before2 + before4 - after1 - after2 - after4;
+                            // clang-format on
+                        }
+                        else
+                        {
+                            // clang-format off
                             const auto before1 = weights(paths[a1][i - 1], paths[a1][i    ]);
                             const auto before2 = weights(paths[a1][i    ], paths[a1][i + 1]);
                             const auto before3 = weights(paths[a2][j - 1], paths[a2][j    ]);
@@ -507,49 +1663,497 @@ std::tuple<std::vector<std::vector<size_t>>, double> TwoOptPaths(
     return { paths, improvementSum };
 }
 
-double CalculatePathLength(const std::vector<size_t>& path, const xt::xarray<double> weights)
+template <typename Weights>
+double PathLength(const std::vector<size_t>& path, const Weights& weights)
 {
-    [[maybe_unused]] const auto N = weights.shape(0);
-    assert(weights.dimension() == 2);
-    assert(weights.shape(1) == N);
+    [[maybe_unused]] const auto N = weights.N();
 
     double length = 0.0;
     for (size_t i = 1; i < path.size(); ++i)
     {
         assert(path[i - 1] < N);
         assert(path[i] < N);
-        length += weights(path[i - 1], path[i]);
+        const double weight = weights(path[i - 1], path[i]);
+        length += weight;
     }
 
     return length;
 }
 
-double CalculateObjective(
+template <typename Weights>
+double Objective(
     const OptimizationMode optimizationMode, const std::vector<std::vector<size_t>>& paths,
-    const xt::xarray<double> weights)
+    const Weights& weights)
 {
-    const auto A = paths.size();
+    double objective = 0.0;
+    switch (optimizationMode)
+    {
+    case OptimizationMode::Sum:
+        for (const auto& path : paths)
+            objective += PathLength(path, weights);
+        break;
+    case OptimizationMode::Max:
+        for (const auto& path : paths)
+            objective = std::max(PathLength(path, weights), objective);
+        break;
+    }
 
-    assert(weights.dimension() == 2 || weights.dimension() == 3);
-    assert(weights.dimension() == 2 || weights.shape(0) == A);
+    return objective;
+}
 
-    double objective = 0.0;
+template <typename Weights>
+std::tuple<std::vector<std::vector<size_t>>, double> RunLocalSearch(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths, Weights weights,
+    const DependencyGraph& dependencies, const NeighborLists& neighborLists,
+    std::chrono::steady_clock::time_point endTime)
+{
+    LocalSearch localSearch(
+        optimizationMode, std::move(paths), weights, dependencies, neighborLists);
+    const auto improvement = localSearch.Run(endTime);
+
+    return { localSearch.ExtractPaths(), improvement };
+}
+}
+
+std::tuple<std::vector<std::vector<size_t>>, double> TwoOptPaths(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths, WeightsView weights,
+    const DependencyGraph& dependencies, std::chrono::steady_clock::time_point endTime)
+{
+    switch (optimizationMode)
+    {
+    case OptimizationMode::Max:
+        return TwoOptPathsForMode<OptimizationMode::Max>(
+            std::move(paths), weights, dependencies, endTime);
+    case OptimizationMode::Sum:
+        return TwoOptPathsForMode<OptimizationMode::Sum>(
+            std::move(paths), weights, dependencies, endTime);
+    default:
+        throw TsplpException();
+    }
+}
+
+std::tuple<std::vector<std::vector<size_t>>, double> LocalSearchPaths(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths, WeightsView weights,
+    const DependencyGraph& dependencies, const NeighborLists& neighborLists,
+    std::chrono::steady_clock::time_point endTime)
+{
+    return RunLocalSearch(
+        optimizationMode, std::move(paths), weights, dependencies, neighborLists, endTime);
+}
+
+std::tuple<std::vector<std::vector<size_t>>, double> LocalSearchPaths(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths,
+    CoordinateWeights weights, const DependencyGraph& dependencies,
+    const NeighborLists& neighborLists, std::chrono::steady_clock::time_point endTime)
+{
+    return RunLocalSearch(
+        optimizationMode, std::move(paths), weights, dependencies, neighborLists, endTime);
+}
+
+std::tuple<std::vector<std::vector<size_t>>, double> NearestNeighborPaths(
+    OptimizationMode optimizationMode, CoordinateWeights weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions)
+{
+    const auto A = startPositions.size();
+    assert(endPositions.size() == A);
+
+    KdTree tree(weights);
+    auto numberOfFreeNodes = weights.N();
     for (size_t a = 0; a < A; ++a)
     {
-        const auto pathLength = CalculatePathLength(
-            paths[a], weights.dimension() == 2 ? weights : xt::view(weights, a));
+        for (const auto n : { startPositions[a], endPositions[a] })
+        {
+            if (!tree.IsRemoved(n))
+            {
+                tree.Remove(n);
+                --numberOfFreeNodes;
+            }
+        }
+    }
 
-        switch (optimizationMode)
+    std::vector<std::vector<size_t>> paths(A);
+    for (size_t a = 0; a < A; ++a)
+    {
+        // the first paths take the remainder, so that all nodes are visited
+        const auto length = numberOfFreeNodes / A + (a < numberOfFreeNodes % A ? 1 : 0);
+        paths[a].reserve(length + 2);
+        paths[a].push_back(startPositions[a]);
+        for (size_t i = 0; i < length; ++i)
         {
-        case OptimizationMode::Sum:
-            objective += pathLength;
-            break;
-        case OptimizationMode::Max:
-            objective = std::max(pathLength, objective);
+            const auto next = tree.FindNearestRemaining(paths[a].back());
+            assert(next < weights.N());
+            tree.Remove(next);
+            paths[a].push_back(next);
+        }
+        paths[a].push_back(endPositions[a]);
+    }
+
+    const auto objective = CalculateObjective(optimizationMode, paths, weights);
+    return { std::move(paths), objective };
+}
+
+namespace
+{
+// Local search keeps track of a single position per node, so like the WeightManager, every start
+// or end node that is used more than once gets a copy at the same coordinates, appended after the
+// original nodes.
+struct CopiedTerminals
+{
+    std::vector<double> X;
+    std::vector<double> Y;
+    std::vector<size_t> ToOriginal;
+    xt::xtensor<size_t, 1> StartPositions;
+    xt::xtensor<size_t, 1> EndPositions;
+};
+
+std::optional<CopiedTerminals> CopySharedTerminals(
+    CoordinateWeights weights, const xt::xtensor<size_t, 1>& startPositions,
+    const xt::xtensor<size_t, 1>& endPositions)
+{
+    const auto N = weights.N();
+
+    CopiedTerminals copied { .X = {},
+                             .Y = {},
+                             .ToOriginal = {},
+                             .StartPositions = startPositions,
+                             .EndPositions = endPositions };
+
+    std::vector<bool> isInUse(N, false);
+    for (size_t a = 0; a < startPositions.size(); ++a)
+    {
+        for (auto* position : { &copied.StartPositions[a], &copied.EndPositions[a] })
+        {
+            if (*position >= N)
+                throw std::runtime_error("Invalid start or end position.");
+
+            if (isInUse[*position])
+            {
+                copied.ToOriginal.push_back(*position);
+                *position = N + copied.ToOriginal.size() - 1;
+            }
+            else
+            {
+                isInUse[*position] = true;
+            }
+        }
+    }
+
+    if (copied.ToOriginal.empty())
+        return std::nullopt;
+
+    copied.X.reserve(N + copied.ToOriginal.size());
+    copied.Y.reserve(N + copied.ToOriginal.size());
+    for (size_t n = 0; n < N + copied.ToOriginal.size(); ++n)
+    {
+        const auto original = n < N ? n : copied.ToOriginal[n - N];
+        copied.X.push_back(weights.X(original));
+        copied.Y.push_back(weights.Y(original));
+    }
+
+    return copied;
+}
+
+// Solves the instance with copied terminals and maps the copies back to their original nodes.
+template <typename Solve>
+std::tuple<std::vector<std::vector<size_t>>, double> SolveWithCopiedTerminals(
+    Solve solve, OptimizationMode optimizationMode, CoordinateWeights weights,
+    const CopiedTerminals& copied, std::chrono::steady_clock::time_point endTime,
+    size_t numberOfThreads)
+{
+    auto [paths, _] = solve(
+        optimizationMode, CoordinateWeights { copied.X, copied.Y, weights.GetDistanceFunction() },
+        copied.StartPositions, copied.EndPositions, endTime, numberOfThreads);
+
+    for (auto& path : paths)
+    {
+        for (auto& n : path)
+        {
+            if (n >= weights.N())
+                n = copied.ToOriginal[n - weights.N()];
+        }
+    }
+
+    // for Geo, copies at the same coordinates are not at distance 0 from each other
+    const auto objective = CalculateObjective(optimizationMode, paths, weights);
+    return { std::move(paths), objective };
+}
+}
+
+std::tuple<std::vector<std::vector<size_t>>, double> HeuristicSolve(
+    OptimizationMode optimizationMode, CoordinateWeights weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
+    std::chrono::steady_clock::time_point endTime, size_t numberOfThreads)
+{
+    if (const auto copied = CopySharedTerminals(weights, startPositions, endPositions))
+    {
+        return SolveWithCopiedTerminals(
+            &HeuristicSolve, optimizationMode, weights, *copied, endTime, numberOfThreads);
+    }
+
+    const NeighborLists neighborLists(weights, NeighborLists::DefaultK, numberOfThreads);
+    const DependencyGraph dependencies(weights.N());
+
+    auto [paths, _] = NearestNeighborPaths(optimizationMode, weights, startPositions, endPositions);
+    auto [improvedPaths, improvement] = LocalSearchPaths(
+        optimizationMode, std::move(paths), weights, dependencies, neighborLists, endTime);
+
+    const auto objective = CalculateObjective(optimizationMode, improvedPaths, weights);
+    return { std::move(improvedPaths), objective };
+}
+
+namespace
+{
+// One level of the multilevel scheme: the coordinates of its nodes, and for each of them the one
+// or two nodes of the next finer level that it stands for.
+struct CoarseLevel
+{
+    std::vector<double> X;
+    std::vector<double> Y;
+    std::vector<std::vector<size_t>> Children;
+    xt::xtensor<size_t, 1> StartPositions;
+    xt::xtensor<size_t, 1> EndPositions;
+};
+
+// Contracts every free node with its nearest free neighbor into a node at their midpoint. Start
+// and end nodes are never contracted.
+CoarseLevel Coarsen(
+    CoordinateWeights weights, const xt::xtensor<size_t, 1>& startPositions,
+    const xt::xtensor<size_t, 1>& endPositions)
+{
+    const auto N = weights.N();
+
+    CoarseLevel level;
+    const auto addNode = [&](std::vector<size_t> children)
+    {
+        double x = 0.0;
+        double y = 0.0;
+        for (const auto c : children)
+        {
+            x += weights.X(c);
+            y += weights.Y(c);
+        }
+
+        level.X.push_back(x / static_cast<double>(children.size()));
+        level.Y.push_back(y / static_cast<double>(children.size()));
+        level.Children.push_back(std::move(children));
+    };
+
+    std::vector<size_t> parents(N, N);
+    KdTree tree(weights);
+    for (const auto* positions : { &startPositions, &endPositions })
+    {
+        for (const auto n : *positions)
+        {
+            if (parents[n] == N)
+            {
+                parents[n] = level.Children.size();
+                addNode({ n });
+                tree.Remove(n);
+            }
+        }
+    }
+
+    for (size_t n = 0; n < N; ++n)
+    {
+        if (tree.IsRemoved(n))
+            continue;
+
+        tree.Remove(n);
+        const auto nearest = tree.FindNearestRemaining(n);
+        if (nearest == N)
+        {
+            addNode({ n });
+            continue;
+        }
+
+        tree.Remove(nearest);
+        addNode({ n, nearest });
+    }
+
+    level.StartPositions = xt::xtensor<size_t, 1>::from_shape({ startPositions.size() });
+    level.EndPositions = xt::xtensor<size_t, 1>::from_shape({ endPositions.size() });
+    for (size_t a = 0; a < startPositions.size(); ++a)
+    {
+        level.StartPositions[a] = parents[startPositions[a]];
+        level.EndPositions[a] = parents[endPositions[a]];
+    }
+
+    return level;
+}
+
+// Local search of each path, split into segments with fixed ends that are improved in parallel,
+// followed by local search of the whole paths. Shortening a segment never lengthens its path, so
+// the segments are improved in Sum mode.
+std::vector<std::vector<size_t>> RefineInParallel(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths,
+    CoordinateWeights weights, const DependencyGraph& dependencies,
+    const NeighborLists& neighborLists, std::chrono::steady_clock::time_point endTime,
+    size_t numberOfThreads)
+{
+    constexpr size_t minSegmentLength = 100;
+
+    // first and last position of each segment, both included
+    std::vector<std::tuple<size_t, size_t, size_t>> segments;
+    const auto segmentsPerPath = (numberOfThreads + paths.size() - 1) / paths.size();
+    for (size_t a = 0; a < paths.size(); ++a)
+    {
+        const auto segmentLength
+            = std::max(minSegmentLength, (paths[a].size() + segmentsPerPath - 1) / segmentsPerPath);
+        for (size_t first = 0; first + 1 < paths[a].size(); first += segmentLength)
+            segments.emplace_back(a, first, std::min(first + segmentLength, paths[a].size() - 1));
+    }
+
+    if (numberOfThreads > 1 && segments.size() > 1)
+    {
+        std::mutex mutex;
+        size_t nextSegment = 0;
+
+        const auto threadLoop = [&]
+        {
+            while (std::chrono::steady_clock::now() < endTime)
+            {
+                size_t segment = 0;
+                {
+                    std::unique_lock lock { mutex };
+                    if (nextSegment == segments.size())
+                        break;
+                    segment = nextSegment++;
+                }
+
+                // Neighboring segments share their first or last node, which the local search
+                // keeps. So only the interior is copied back, and the shared nodes are only read.
+                const auto [a, first, last] = segments[segment];
+                const auto begin = paths[a].begin() + static_cast<std::ptrdiff_t>(first);
+                const auto end = paths[a].begin() + static_cast<std::ptrdiff_t>(last) + 1;
+
+                auto [improvedSegments, _] = LocalSearchPaths(
+                    OptimizationMode::Sum, { std::vector<size_t>(begin, end) }, weights,
+                    dependencies, neighborLists, endTime);
+                std::copy(
+                    improvedSegments[0].begin() + 1, improvedSegments[0].end() - 1, begin + 1);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < std::min(numberOfThreads, segments.size()); ++t)
+            threads.emplace_back(threadLoop);
+
+        threadLoop();
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    // connects the segments, and only the nodes next to their ends are likely to move
+    auto [improvedPaths, _] = LocalSearchPaths(
+        optimizationMode, std::move(paths), weights, dependencies, neighborLists, endTime);
+
+    return improvedPaths;
+}
+}
+
+std::tuple<std::vector<std::vector<size_t>>, double> MultilevelSolve(
+    OptimizationMode optimizationMode, CoordinateWeights weights,
+    const xt::xtensor<size_t, 1>& startPositions, const xt::xtensor<size_t, 1>& endPositions,
+    std::chrono::steady_clock::time_point endTime, size_t numberOfThreads)
+{
+    constexpr size_t coarsestN = 1000;
+
+    if (const auto copied = CopySharedTerminals(weights, startPositions, endPositions))
+    {
+        return SolveWithCopiedTerminals(
+            &MultilevelSolve, optimizationMode, weights, *copied, endTime, numberOfThreads);
+    }
+
+    // levels[0] are the given nodes, each contains half as many nodes as the one before
+    std::vector<CoarseLevel> levels;
+    levels.push_back({ .X = std::vector<double>(weights.N()),
+                       .Y = std::vector<double>(weights.N()),
+                       .Children = {},
+                       .StartPositions = startPositions,
+                       .EndPositions = endPositions });
+    for (size_t n = 0; n < weights.N(); ++n)
+    {
+        levels[0].X[n] = weights.X(n);
+        levels[0].Y[n] = weights.Y(n);
+    }
+
+    const auto levelWeights = [&](size_t l)
+    { return CoordinateWeights { levels[l].X, levels[l].Y, weights.GetDistanceFunction() }; };
+
+    while (levels.back().X.size() > coarsestN)
+    {
+        auto coarseLevel = Coarsen(
+            levelWeights(levels.size() - 1), levels.back().StartPositions,
+            levels.back().EndPositions);
+
+        // only the terminals are left
+        if (coarseLevel.X.size() == levels.back().X.size())
             break;
+
+        levels.push_back(std::move(coarseLevel));
+    }
+
+    auto [paths, _] = HeuristicSolve(
+        optimizationMode, levelWeights(levels.size() - 1), levels.back().StartPositions,
+        levels.back().EndPositions, endTime, numberOfThreads);
+
+    for (auto l = levels.size() - 1; l > 0; --l)
+    {
+        // each node is replaced by its children, the one closer to the previous node first
+        const auto fineWeights = levelWeights(l - 1);
+        for (auto& path : paths)
+        {
+            std::vector<size_t> finePath;
+            finePath.reserve(2 * path.size());
+            for (const auto n : path)
+            {
+                auto children = levels[l].Children[n];
+                if (children.size() == 2 && !finePath.empty()
+                    && fineWeights(finePath.back(), children[1])
+                        < fineWeights(finePath.back(), children[0]))
+                {
+                    std::swap(children[0], children[1]);
+                }
+
+                finePath.insert(finePath.end(), children.begin(), children.end());
+            }
+
+            path = std::move(finePath);
         }
+
+        const NeighborLists neighborLists(fineWeights, NeighborLists::DefaultK, numberOfThreads);
+        const DependencyGraph dependencies(fineWeights.N());
+        paths = RefineInParallel(
+            optimizationMode, std::move(paths), fineWeights, dependencies, neighborLists, endTime,
+            numberOfThreads);
     }
 
-    return objective;
+    const auto objective = CalculateObjective(optimizationMode, paths, weights);
+    return { std::move(paths), objective };
+}
+
+double CalculatePathLength(const std::vector<size_t>& path, WeightsView weights)
+{
+    return PathLength(path, weights);
+}
+
+double CalculatePathLength(const std::vector<size_t>& path, CoordinateWeights weights)
+{
+    return PathLength(path, weights);
+}
+
+double CalculateObjective(
+    const OptimizationMode optimizationMode, const std::vector<std::vector<size_t>>& paths,
+    WeightsView weights)
+{
+    return Objective(optimizationMode, paths, weights);
+}
+
+double CalculateObjective(
+    const OptimizationMode optimizationMode, const std::vector<std::vector<size_t>>& paths,
+    CoordinateWeights weights)
+{
+    return Objective(optimizationMode, paths, weights);
+}
 }
-}
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "InsertionKernels.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TSPLP_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace tsplp
+{
+namespace
+{
+// Gathers only pay off once they hide the latency of loading scattered weights. Measured on the
+// TSPLIB instances rat783 and dsj1000, AVX-512 breaks even with scalar code at about 400 positions
+// and AVX2 at about 500.
+constexpr size_t minVectorizedPositions = 512;
+
+InsertionPosition FindScalar(
+    const AgentWeights& weights, size_t a, std::span<const size_t> path, size_t first, size_t n,
+    InsertionPosition best)
+{
+    for (auto i = first; i < path.size(); ++i)
+    {
+        const auto delta = weights(a, path[i - 1], n) + weights(a, n, path[i])
+            - weights(a, path[i - 1], path[i]);
+        if (delta < best.Delta)
+            best = { delta, i };
+    }
+
+    return best;
+}
+
+#ifdef TSPLP_X86_KERNELS
+// Every lane holds the best position among every width-th position, so ties between lanes are
+// broken by the position.
+template <size_t width>
+InsertionPosition ReduceLanes(
+    const std::array<double, width>& deltas, const std::array<std::int64_t, width>& positions,
+    size_t end)
+{
+    InsertionPosition best { std::numeric_limits<double>::max(), end };
+    for (size_t lane = 0; lane < width; ++lane)
+    {
+        const auto position = static_cast<size_t>(positions[lane]);
+        if (deltas[lane] < best.Delta || (deltas[lane] == best.Delta && position < best.Position))
+            best = { deltas[lane], position };
+    }
+
+    return best;
+}
+
+// The nodes of the path are loaded as 64 bit indices, which are multiplied by the strides with
+// 32 bit multiplications. This is exact as long as N < 2^32. The fractional solution is stored
+// contiguously, the weights of agent a start at a * N * N.
+
+__attribute__((target("avx2"))) InsertionPosition FindAvx2(
+    const AgentWeights& weights, size_t a, std::span<const size_t> path, size_t first, size_t n)
+{
+    constexpr size_t width = 4;
+
+    const auto view = weights.Base();
+    const auto* fractionalSolution = weights.FractionalSolution();
+    const auto N = view.N();
+
+    const auto rowStride = _mm256_set1_epi64x(static_cast<std::int64_t>(view.RowStride()));
+    const auto columnStride = _mm256_set1_epi64x(static_cast<std::int64_t>(view.ColumnStride()));
+    const auto nInRow = _mm256_set1_epi64x(static_cast<std::int64_t>(n * view.RowStride()));
+    const auto nInColumn = _mm256_set1_epi64x(static_cast<std::int64_t>(n * view.ColumnStride()));
+
+    const auto fractionalRowStride = _mm256_set1_epi64x(static_cast<std::int64_t>(N));
+    const auto fractionalOffset = _mm256_set1_epi64x(static_cast<std::int64_t>(a * N * N));
+    const auto fractionalN = _mm256_set1_epi64x(static_cast<std::int64_t>(n));
+    const auto fractionalNInRow = _mm256_set1_epi64x(static_cast<std::int64_t>(a * N * N + n * N));
+    const auto one = _mm256_set1_pd(1.0);
+
+    auto bestDeltas = _mm256_set1_pd(std::numeric_limits<double>::max());
+    auto bestPositions = _mm256_set1_epi64x(static_cast<std::int64_t>(path.size()));
+    auto positions = _mm256_add_epi64(
+        _mm256_set1_epi64x(static_cast<std::int64_t>(first)), _mm256_setr_epi64x(0, 1, 2, 3));
+    const auto step = _mm256_set1_epi64x(static_cast<std::int64_t>(width));
+
+    auto i = first;
+    for (; i + width <= path.size(); i += width)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        const auto u = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&path[i - 1]));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&path[i]));
+
+        const auto uRow = _mm256_mul_epu32(u, rowStride);
+        const auto vColumn = _mm256_mul_epu32(v, columnStride);
+        auto un = _mm256_i64gather_pd(view.Data(), _mm256_add_epi64(uRow, nInColumn), 8);
+        auto nv = _mm256_i64gather_pd(view.Data(), _mm256_add_epi64(nInRow, vColumn), 8);
+        auto uv = _mm256_i64gather_pd(view.Data(), _mm256_add_epi64(uRow, vColumn), 8);
+
+        if (fractionalSolution != nullptr)
+        {
+            const auto uFractionalRow
+                = _mm256_add_epi64(fractionalOffset, _mm256_mul_epu32(u, fractionalRowStride));
+            const auto xun = _mm256_i64gather_pd(
+                fractionalSolution, _mm256_add_epi64(uFractionalRow, fractionalN), 8);
+            const auto xnv = _mm256_i64gather_pd(
+                fractionalSolution, _mm256_add_epi64(fractionalNInRow, v), 8);
+            const auto xuv
+                = _mm256_i64gather_pd(fractionalSolution, _mm256_add_epi64(uFractionalRow, v), 8);
+            un = _mm256_mul_pd(_mm256_sub_pd(one, xun), un);
+            nv = _mm256_mul_pd(_mm256_sub_pd(one, xnv), nv);
+            uv = _mm256_mul_pd(_mm256_sub_pd(one, xuv), uv);
+        }
+
+        const auto deltas = _mm256_sub_pd(_mm256_add_pd(un, nv), uv);
+        const auto isBetter = _mm256_cmp_pd(deltas, bestDeltas, _CMP_LT_OQ);
+        bestDeltas = _mm256_blendv_pd(bestDeltas, deltas, isBetter);
+        bestPositions = _mm256_castpd_si256(_mm256_blendv_pd(
+            _mm256_castsi256_pd(bestPositions), _mm256_castsi256_pd(positions), isBetter));
+        positions = _mm256_add_epi64(positions, step);
+    }
+
+    std::array<double, width> laneDeltas {};
+    std::array<std::int64_t, width> lanePositions {};
+    _mm256_storeu_pd(laneDeltas.data(), bestDeltas);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanePositions.data()), bestPositions);
+
+    return FindScalar(
+        weights, a, path, i, n, ReduceLanes(laneDeltas, lanePositions, path.size()));
+}
+
+// The AVX-512 gathers of GCC convert the mask to char and start from an undefined register.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#if !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+__attribute__((target("avx512f"))) InsertionPosition FindAvx512(
+    const AgentWeights& weights, size_t a, std::span<const size_t> path, size_t first, size_t n)
+{
+    constexpr size_t width = 8;
+
+    const auto view = weights.Base();
+    const auto* fractionalSolution = weights.FractionalSolution();
+    const auto N = view.N();
+
+    const auto rowStride = _mm512_set1_epi64(static_cast<std::int64_t>(view.RowStride()));
+    const auto columnStride = _mm512_set1_epi64(static_cast<std::int64_t>(view.ColumnStride()));
+    const auto nInRow = _mm512_set1_epi64(static_cast<std::int64_t>(n * view.RowStride()));
+    const auto nInColumn = _mm512_set1_epi64(static_cast<std::int64_t>(n * view.ColumnStride()));
+
+    const auto fractionalRowStride = _mm512_set1_epi64(static_cast<std::int64_t>(N));
+    const auto fractionalOffset = _mm512_set1_epi64(static_cast<std::int64_t>(a * N * N));
+    const auto fractionalN = _mm512_set1_epi64(static_cast<std::int64_t>(n));
+    const auto fractionalNInRow = _mm512_set1_epi64(static_cast<std::int64_t>(a * N * N + n * N));
+    const auto one = _mm512_set1_pd(1.0);
+
+    auto bestDeltas = _mm512_set1_pd(std::numeric_limits<double>::max());
+    auto bestPositions = _mm512_set1_epi64(static_cast<std::int64_t>(path.size()));
+    auto positions = _mm512_add_epi64(
+        _mm512_set1_epi64(static_cast<std::int64_t>(first)),
+        _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+    const auto step = _mm512_set1_epi64(static_cast<std::int64_t>(width));
+
+    auto i = first;
+    for (; i + width <= path.size(); i += width)
+    {
+        const auto u = _mm512_loadu_si512(&path[i - 1]);
+        const auto v = _mm512_loadu_si512(&path[i]);
+
+        const auto uRow = _mm512_mul_epu32(u, rowStride);
+        const auto vColumn = _mm512_mul_epu32(v, columnStride);
+        auto un = _mm512_i64gather_pd(_mm512_add_epi64(uRow, nInColumn), view.Data(), 8);
+        auto nv = _mm512_i64gather_pd(_mm512_add_epi64(nInRow, vColumn), view.Data(), 8);
+        auto uv = _mm512_i64gather_pd(_mm512_add_epi64(uRow, vColumn), view.Data(), 8);
+
+        if (fractionalSolution != nullptr)
+        {
+            const auto uFractionalRow
+                = _mm512_add_epi64(fractionalOffset, _mm512_mul_epu32(u, fractionalRowStride));
+            const auto xun = _mm512_i64gather_pd(
+                _mm512_add_epi64(uFractionalRow, fractionalN), fractionalSolution, 8);
+            const auto xnv = _mm512_i64gather_pd(
+                _mm512_add_epi64(fractionalNInRow, v), fractionalSolution, 8);
+            const auto xuv
+                = _mm512_i64gather_pd(_mm512_add_epi64(uFractionalRow, v), fractionalSolution, 8);
+            un = _mm512_mul_pd(_mm512_sub_pd(one, xun), un);
+            nv = _mm512_mul_pd(_mm512_sub_pd(one, xnv), nv);
+            uv = _mm512_mul_pd(_mm512_sub_pd(one, xuv), uv);
+        }
+
+        const auto deltas = _mm512_sub_pd(_mm512_add_pd(un, nv), uv);
+        const auto isBetter = _mm512_cmp_pd_mask(deltas, bestDeltas, _CMP_LT_OQ);
+        bestDeltas = _mm512_mask_blend_pd(isBetter, bestDeltas, deltas);
+        bestPositions = _mm512_mask_blend_epi64(isBetter, bestPositions, positions);
+        positions = _mm512_add_epi64(positions, step);
+    }
+
+    std::array<double, width> laneDeltas {};
+    std::array<std::int64_t, width> lanePositions {};
+    _mm512_storeu_pd(laneDeltas.data(), bestDeltas);
+    _mm512_storeu_si512(lanePositions.data(), bestPositions);
+
+    return FindScalar(
+        weights, a, path, i, n, ReduceLanes(laneDeltas, lanePositions, path.size()));
+}
+
+#pragma GCC diagnostic pop
+#endif
+}
+
+InstructionSet GetSupportedInstructionSet()
+{
+#ifdef TSPLP_X86_KERNELS
+    static const auto instructionSet = []
+    {
+        if (__builtin_cpu_supports("avx512f"))
+            return InstructionSet::Avx512;
+        if (__builtin_cpu_supports("avx2"))
+            return InstructionSet::Avx2;
+        return InstructionSet::Scalar;
+    }();
+
+    return instructionSet;
+#else
+    return InstructionSet::Scalar;
+#endif
+}
+
+InsertionPosition FindCheapestInsertionPosition(
+    const AgentWeights& weights, size_t a, std::span<const size_t> path, size_t first, size_t n,
+    [[maybe_unused]] InstructionSet instructionSet)
+{
+    assert(first > 0);
+
+#ifdef TSPLP_X86_KERNELS
+    if (first + minVectorizedPositions <= path.size())
+    {
+        if (instructionSet == InstructionSet::Avx512)
+            return FindAvx512(weights, a, path, first, n);
+        if (instructionSet == InstructionSet::Avx2)
+            return FindAvx2(weights, a, path, first, n);
+    }
+#endif
+
+    return FindScalar(
+        weights, a, path, first, n, { std::numeric_limits<double>::max(), path.size() });
+}
+}
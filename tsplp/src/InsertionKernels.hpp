@@ -0,0 +1,35 @@
+#pragma once
+
+#include "AgentWeights.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <span>
+
+namespace tsplp
+{
+enum class InstructionSet
+{
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+// The widest instruction set supported by the CPU, determined once.
+[[nodiscard]] InstructionSet GetSupportedInstructionSet();
+
+struct InsertionPosition
+{
+    double Delta = std::numeric_limits<double>::max();
+    size_t Position = 0;
+};
+
+// The position i in [first, path.size()) in front of which inserting n into the path of agent a is
+// cheapest, i.e. where w(p[i - 1], n) + w(n, p[i]) - w(p[i - 1], p[i]) is minimal. Ties are broken
+// by the smallest position, so all instruction sets give the same result. If the range is empty,
+// Delta is max() and Position is path.size(). The instruction set must be supported by the CPU, it
+// is only used for long ranges.
+[[nodiscard]] InsertionPosition FindCheapestInsertionPosition(
+    const AgentWeights& weights, size_t a, std::span<const size_t> path, size_t first, size_t n,
+    InstructionSet instructionSet = GetSupportedInstructionSet());
+}
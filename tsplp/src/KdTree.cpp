@@ -0,0 +1,195 @@
+#include "KdTree.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+namespace tsplp
+{
+KdTree::KdTree(CoordinateWeights weights)
+    : m_points(weights.N())
+    , m_order(weights.N())
+    , m_node2Position(weights.N())
+    , m_splitDimensions(weights.N())
+    , m_remainingCounts(weights.N())
+    , m_isRemoved(weights.N(), false)
+{
+    for (size_t n = 0; n < weights.N(); ++n)
+    {
+        if (weights.GetDistanceFunction() == DistanceFunction::Geo)
+        {
+            const auto latitude = CoordinateWeights::ToGeoRadians(weights.X(n));
+            const auto longitude = CoordinateWeights::ToGeoRadians(weights.Y(n));
+            m_points[n] = { std::cos(latitude) * std::cos(longitude),
+                            std::cos(latitude) * std::sin(longitude), std::sin(latitude) };
+        }
+        else
+        {
+            m_points[n] = { weights.X(n), weights.Y(n), 0.0 };
+        }
+    }
+
+    std::iota(m_order.begin(), m_order.end(), 0);
+    Build(0, m_order.size());
+
+    for (size_t i = 0; i < m_order.size(); ++i)
+        m_node2Position[m_order[i]] = i;
+}
+
+// Calls visit for every node in [begin, end) that is closer to n than bound, which visit may
+// shrink. Subtrees that are farther away than bound are skipped.
+template <typename Visit>
+void KdTree::Search(
+    size_t n, size_t begin, size_t end, bool skipRemoved, double& bound, Visit&& visit) const
+{
+    if (begin == end)
+        return;
+
+    const auto mid = begin + (end - begin) / 2;
+    if (skipRemoved && m_remainingCounts[mid] == 0)
+        return;
+
+    const auto v = m_order[mid];
+    if (v != n && !(skipRemoved && m_isRemoved[v]))
+    {
+        if (const auto squaredDistance = SquaredDistance(n, v); squaredDistance < bound)
+            visit(v, squaredDistance);
+    }
+
+    const auto dimension = m_splitDimensions[mid];
+    const auto difference = m_points[n][dimension] - m_points[v][dimension];
+    const auto [nearBegin, nearEnd, farBegin, farEnd] = difference < 0
+        ? std::tuple { begin, mid, mid + 1, end }
+        : std::tuple { mid + 1, end, begin, mid };
+
+    Search(n, nearBegin, nearEnd, skipRemoved, bound, visit);
+    if (difference * difference < bound)
+        Search(n, farBegin, farEnd, skipRemoved, bound, visit);
+}
+
+std::vector<size_t> KdTree::FindNearest(size_t n, size_t k) const
+{
+    // max heap of the k nearest nodes found so far
+    std::vector<std::pair<double, size_t>> nearest;
+    nearest.reserve(k + 1);
+
+    auto bound = k > 0 ? std::numeric_limits<double>::max() : 0.0;
+    Search(
+        n, 0, m_order.size(), false, bound,
+        [&](size_t v, double squaredDistance)
+        {
+            nearest.emplace_back(squaredDistance, v);
+            std::push_heap(nearest.begin(), nearest.end());
+            if (nearest.size() > k)
+            {
+                std::pop_heap(nearest.begin(), nearest.end());
+                nearest.pop_back();
+            }
+
+            if (nearest.size() == k)
+                bound = nearest.front().first;
+        });
+
+    std::sort_heap(nearest.begin(), nearest.end());
+
+    std::vector<size_t> result;
+    result.reserve(nearest.size());
+    for (const auto& [_, v] : nearest)
+        result.push_back(v);
+
+    return result;
+}
+
+size_t KdTree::FindNearestRemaining(size_t n) const
+{
+    auto nearest = m_order.size();
+    auto bound = std::numeric_limits<double>::max();
+    Search(
+        n, 0, m_order.size(), true, bound,
+        [&](size_t v, double squaredDistance)
+        {
+            nearest = v;
+            bound = squaredDistance;
+        });
+
+    return nearest;
+}
+
+void KdTree::Remove(size_t n)
+{
+    assert(!m_isRemoved[n]);
+    m_isRemoved[n] = true;
+
+    const auto position = m_node2Position[n];
+    size_t begin = 0;
+    auto end = m_order.size();
+    while (true)
+    {
+        const auto mid = begin + (end - begin) / 2;
+        --m_remainingCounts[mid];
+        if (position == mid)
+            break;
+
+        if (position < mid)
+            end = mid;
+        else
+            begin = mid + 1;
+    }
+}
+
+void KdTree::Build(size_t begin, size_t end)
+{
+    if (begin == end)
+        return;
+
+    // split along the dimension with the largest extent
+    Point lower;
+    Point upper;
+    lower.fill(std::numeric_limits<double>::max());
+    upper.fill(std::numeric_limits<double>::lowest());
+    for (auto i = begin; i < end; ++i)
+    {
+        for (size_t d = 0; d < lower.size(); ++d)
+        {
+            lower[d] = std::min(lower[d], m_points[m_order[i]][d]);
+            upper[d] = std::max(upper[d], m_points[m_order[i]][d]);
+        }
+    }
+
+    size_t dimension = 0;
+    for (size_t d = 1; d < lower.size(); ++d)
+    {
+        if (upper[d] - lower[d] > upper[dimension] - lower[dimension])
+            dimension = d;
+    }
+
+    const auto mid = begin + (end - begin) / 2;
+    std::nth_element(
+        m_order.begin() + static_cast<std::ptrdiff_t>(begin),
+        m_order.begin() + static_cast<std::ptrdiff_t>(mid),
+        m_order.begin() + static_cast<std::ptrdiff_t>(end), [&](size_t u, size_t v)
+        { return m_points[u][dimension] < m_points[v][dimension]; });
+
+    m_splitDimensions[mid] = dimension;
+    m_remainingCounts[mid] = end - begin;
+
+    Build(begin, mid);
+    Build(mid + 1, end);
+}
+
+double KdTree::SquaredDistance(size_t u, size_t v) const
+{
+    double squaredDistance = 0.0;
+    for (size_t d = 0; d < m_points[u].size(); ++d)
+    {
+        const auto difference = m_points[u][d] - m_points[v][d];
+        squaredDistance += difference * difference;
+    }
+
+    return squaredDistance;
+}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CoordinateWeights.hpp"
+
+#include <array>
+#include <vector>
+
+namespace tsplp
+{
+// Static k-d tree over the nodes of coordinate weights, for nearest neighbor queries in
+// O(log N) on average instead of O(N). Geo nodes are placed on the unit sphere, so that for every
+// distance function the euclidean distance of the points is monotone in the weight, up to
+// rounding of the weights.
+// The tree is implicit: every subtree is a range of m_order with its root in the middle, so
+// it needs O(N) memory. Nodes can be removed to find the nearest of the remaining ones, e.g. for
+// a nearest neighbor tour.
+class KdTree
+{
+private:
+    using Point = std::array<double, 3>;
+
+    std::vector<Point> m_points;
+    std::vector<size_t> m_order;
+    std::vector<size_t> m_node2Position;
+    // by position of the root of the subtree
+    std::vector<size_t> m_splitDimensions;
+    std::vector<size_t> m_remainingCounts;
+    std::vector<bool> m_isRemoved;
+
+public:
+    explicit KdTree(CoordinateWeights weights);
+
+    // The k nearest nodes to n, excluding n, in order of increasing distance. Removed nodes are
+    // included.
+    [[nodiscard]] std::vector<size_t> FindNearest(size_t n, size_t k) const;
+
+    // The nearest node to n that has not been removed, excluding n, or N if there is none.
+    [[nodiscard]] size_t FindNearestRemaining(size_t n) const;
+
+    void Remove(size_t n);
+    [[nodiscard]] bool IsRemoved(size_t n) const { return m_isRemoved[n]; }
+
+private:
+    void Build(size_t begin, size_t end);
+
+    [[nodiscard]] double SquaredDistance(size_t u, size_t v) const;
+
+    template <typename Visit>
+    void Search(
+        size_t n, size_t begin, size_t end, bool skipRemoved, double& bound, Visit&& visit) const;
+};
+}
@@ -0,0 +1,742 @@
+#include "LocalSearch.hpp"
+
+#include "DependencyHelpers.hpp"
+#include "NeighborLists.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace tsplp
+{
+namespace
+{
+constexpr double epsilon = 1.e-10;
+
+constexpr size_t maxOrOptSegmentLength = 3;
+
+constexpr size_t maxLinKernighanDepth = 10;
+}
+
+template <typename Weights>
+LocalSearch<Weights>::LocalSearch(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths, Weights weights,
+    const DependencyGraph& dependencies, const NeighborLists& neighborLists)
+    : m_optimizationMode(optimizationMode)
+    , m_weights(weights)
+    , m_dependencies(dependencies)
+    , m_neighborLists(neighborLists)
+    , m_paths(std::move(paths))
+    , m_forwardCosts(m_paths.size())
+    , m_backwardCosts(m_paths.size())
+    , m_pathLengths(std::vector<double>(m_paths.size(), 0.0))
+    , m_node2Agent(weights.N(), m_paths.size())
+    , m_node2Position(weights.N(), 0)
+    , m_isActive(weights.N(), false)
+{
+    for (size_t a = 0; a < m_paths.size(); ++a)
+    {
+        m_forwardCosts[a].resize(m_paths[a].size());
+        m_backwardCosts[a].resize(m_paths[a].size());
+
+        for (size_t i = 0; i < m_paths[a].size(); ++i)
+        {
+            m_node2Agent[m_paths[a][i]] = a;
+            Activate(m_paths[a][i]);
+        }
+
+        if (!m_paths[a].empty())
+            Update(a, 0, m_paths[a].size() - 1);
+    }
+}
+
+template <typename Weights>
+double LocalSearch<Weights>::GetObjective() const
+{
+    if (m_paths.empty())
+        return 0.0;
+
+    switch (m_optimizationMode)
+    {
+    case OptimizationMode::Sum:
+    {
+        double objective = 0.0;
+        for (size_t a = 0; a < m_paths.size(); ++a)
+            objective += GetPathLength(a);
+        return objective;
+    }
+    case OptimizationMode::Max:
+        return m_pathLengths.GetLongestLength();
+    }
+
+    return 0.0;
+}
+
+template <typename Weights>
+double LocalSearch<Weights>::Run(std::chrono::steady_clock::time_point endTime)
+{
+    const auto initialObjective = GetObjective();
+
+    switch (m_optimizationMode)
+    {
+    case OptimizationMode::Sum:
+        Improve<OptimizationMode::Sum>(endTime);
+        break;
+    case OptimizationMode::Max:
+        Improve<OptimizationMode::Max>(endTime);
+        break;
+    }
+
+    return initialObjective - GetObjective();
+}
+
+template <typename Weights>
+template <OptimizationMode mode>
+void LocalSearch<Weights>::Improve(std::chrono::steady_clock::time_point endTime)
+{
+    while (!m_activeNodes.empty() && std::chrono::steady_clock::now() < endTime)
+    {
+        const auto n = m_activeNodes.front();
+        m_activeNodes.pop_front();
+        m_isActive[n] = false;
+
+        // an improving move activates n again, so one move per examination is enough
+        if (!TryOrOpt(n) && !TryTwoOpt(n) && !TryRelocateBetweenPaths<mode>(n)
+            && !TryCrossExchange<mode>(n))
+        {
+            TryLinKernighan(n);
+        }
+    }
+}
+
+template <typename Weights>
+bool LocalSearch<Weights>::TryOrOpt(size_t n)
+{
+    const auto a = m_node2Agent[n];
+    const auto& path = m_paths[a];
+    const auto L = path.size();
+    const auto i = m_node2Position[n];
+
+    struct
+    {
+        double Delta = -epsilon;
+        size_t First = 0;
+        size_t Last = 0;
+        size_t After = 0;
+        bool IsReversed = false;
+    } best;
+
+    for (size_t segmentLength = 1; segmentLength <= maxOrOptSegmentLength; ++segmentLength)
+    {
+        // consider the segments starting and ending at n
+        for (const auto isEndingAtN : { false, true })
+        {
+            if (isEndingAtN && (segmentLength == 1 || i + 1 < segmentLength))
+                continue;
+
+            const auto first = isEndingAtN ? i + 1 - segmentLength : i;
+            const auto last = first + segmentLength - 1;
+            if (first < 1 || last + 2 > L)
+                continue;
+
+            const auto s0 = path[first];
+            const auto s1 = path[last];
+            const auto removalGain = m_weights(path[first - 1], s0) + m_weights(s1, path[last + 1])
+                - m_weights(path[first - 1], path[last + 1]);
+            const auto reversalDelta
+                = GetReversedSegmentCost(a, first, last) - GetSegmentCost(a, first, last);
+
+            // the segment (s0, ..., s1) is inserted between c and d, optionally as (s1, ..., s0)
+            const auto evaluate = [&](size_t after, bool isReversed)
+            {
+                if (after + 1 >= L || (after + 1 >= first && after <= last))
+                    return;
+
+                const auto c = path[after];
+                const auto d = path[after + 1];
+                const auto delta = isReversed
+                    ? m_weights(c, s1) + m_weights(s0, d) - m_weights(c, d) + reversalDelta
+                        - removalGain
+                    : m_weights(c, s0) + m_weights(s1, d) - m_weights(c, d) - removalGain;
+
+                if (delta < best.Delta && CanRelocate(a, first, last, after)
+                    && (!isReversed || CanReverse(a, first, last)))
+                {
+                    best = { delta, first, last, after, isReversed };
+                }
+            };
+
+            for (const auto isReversed : { false, true })
+            {
+                if (isReversed && segmentLength == 1)
+                    continue;
+
+                const auto head = isReversed ? s1 : s0;
+                const auto tail = isReversed ? s0 : s1;
+
+                for (const auto c : m_neighborLists.GetIncomingSpan(head))
+                {
+                    if (m_node2Agent[c] == a)
+                        evaluate(m_node2Position[c], isReversed);
+                }
+
+                for (const auto d : m_neighborLists.GetOutgoingSpan(tail))
+                {
+                    if (m_node2Agent[d] == a && m_node2Position[d] > 0)
+                        evaluate(m_node2Position[d] - 1, isReversed);
+                }
+            }
+        }
+    }
+
+    if (best.Delta >= -epsilon)
+        return false;
+
+    Relocate(a, best.First, best.Last, best.After, best.IsReversed);
+    return true;
+}
+
+template <typename Weights>
+bool LocalSearch<Weights>::TryTwoOpt(size_t n)
+{
+    const auto a = m_node2Agent[n];
+    const auto& path = m_paths[a];
+    const auto L = path.size();
+    const auto i = m_node2Position[n];
+
+    if (i + 1 >= L)
+        return false;
+
+    struct
+    {
+        double Delta = -epsilon;
+        size_t First = 0;
+        size_t Last = 0;
+    } best;
+
+    const auto evaluate = [&](size_t first, size_t last)
+    {
+        const auto before = path[first - 1];
+        const auto after = path[last + 1];
+        const auto delta = m_weights(before, path[last]) + m_weights(path[first], after)
+            - m_weights(before, path[first]) - m_weights(path[last], after)
+            + GetReversedSegmentCost(a, first, last) - GetSegmentCost(a, first, last);
+
+        if (delta < best.Delta && CanReverse(a, first, last))
+            best = { delta, first, last };
+    };
+
+    // new arc (n, m) with n in front of m, reverse everything from the successor of n to m
+    for (const auto m : m_neighborLists.GetOutgoingSpan(n))
+    {
+        if (m_node2Agent[m] == a && m_node2Position[m] > i + 1 && m_node2Position[m] + 1 < L)
+            evaluate(i + 1, m_node2Position[m]);
+    }
+
+    // new arc (m, n) with m in front of n, reverse everything from the successor of m to n
+    for (const auto m : m_neighborLists.GetIncomingSpan(n))
+    {
+        if (m_node2Agent[m] == a && m_node2Position[m] + 1 < i)
+            evaluate(m_node2Position[m] + 1, i);
+    }
+
+    if (best.Delta >= -epsilon)
+        return false;
+
+    Reverse(a, best.First, best.Last);
+    return true;
+}
+
+template <typename Weights>
+template <OptimizationMode mode>
+bool LocalSearch<Weights>::TryRelocateBetweenPaths(size_t n)
+{
+    const auto a = m_node2Agent[n];
+    const auto& path = m_paths[a];
+    const auto i = m_node2Position[n];
+
+    if (m_paths.size() < 2)
+        return false;
+
+    struct
+    {
+        MoveValue Value;
+        size_t First = 0;
+        size_t Last = 0;
+        size_t B = 0;
+        size_t After = 0;
+    } best;
+
+    for (size_t segmentLength = 1; segmentLength <= maxOrOptSegmentLength; ++segmentLength)
+    {
+        // consider the segments starting and ending at n
+        for (const auto isEndingAtN : { false, true })
+        {
+            if (isEndingAtN && (segmentLength == 1 || i + 1 < segmentLength))
+                continue;
+
+            const auto first = isEndingAtN ? i + 1 - segmentLength : i;
+            const auto last = first + segmentLength - 1;
+            if (first < 1 || last + 2 > path.size() || !CanMoveBetweenPaths(a, first, last))
+                continue;
+
+            const auto s0 = path[first];
+            const auto s1 = path[last];
+            const auto segmentCost = GetSegmentCost(a, first, last);
+            const auto lengthA = GetPathLength(a) - segmentCost - m_weights(path[first - 1], s0)
+                - m_weights(s1, path[last + 1]) + m_weights(path[first - 1], path[last + 1]);
+
+            // the segment (s0, ..., s1) is inserted between c and d in path b
+            const auto evaluate = [&](size_t b, size_t after)
+            {
+                const auto& pathB = m_paths[b];
+                if (after + 1 >= pathB.size())
+                    return;
+
+                const auto c = pathB[after];
+                const auto d = pathB[after + 1];
+                const auto lengthB = GetPathLength(b) + m_weights(c, s0) + segmentCost
+                    + m_weights(s1, d) - m_weights(c, d);
+
+                const auto value = EvaluateBetweenPaths<mode>(a, lengthA, b, lengthB);
+                if (value.Paths < -epsilon && IsBetter(value, best.Value))
+                    best = { value, first, last, b, after };
+            };
+
+            for (const auto c : m_neighborLists.GetIncomingSpan(s0))
+            {
+                if (IsInPath(c) && m_node2Agent[c] != a)
+                    evaluate(m_node2Agent[c], m_node2Position[c]);
+            }
+
+            for (const auto d : m_neighborLists.GetOutgoingSpan(s1))
+            {
+                if (IsInPath(d) && m_node2Agent[d] != a && m_node2Position[d] > 0)
+                    evaluate(m_node2Agent[d], m_node2Position[d] - 1);
+            }
+        }
+    }
+
+    if (best.Value.Paths >= -epsilon)
+        return false;
+
+    ExchangeSegments(a, best.First, best.Last + 1, best.B, best.After + 1, best.After + 1);
+    return true;
+}
+
+template <typename Weights>
+template <OptimizationMode mode>
+bool LocalSearch<Weights>::TryCrossExchange(size_t n)
+{
+    const auto a = m_node2Agent[n];
+    const auto& path = m_paths[a];
+    const auto i = m_node2Position[n];
+
+    if (m_paths.size() < 2)
+        return false;
+
+    struct
+    {
+        MoveValue Value;
+        size_t First = 0;
+        size_t Last = 0;
+        size_t B = 0;
+        size_t FirstB = 0;
+        size_t LastB = 0;
+    } best;
+
+    for (size_t segmentLength = 1; segmentLength <= maxOrOptSegmentLength; ++segmentLength)
+    {
+        // consider the segments starting and ending at n
+        for (const auto isEndingAtN : { false, true })
+        {
+            if (isEndingAtN && (segmentLength == 1 || i + 1 < segmentLength))
+                continue;
+
+            const auto first = isEndingAtN ? i + 1 - segmentLength : i;
+            const auto last = first + segmentLength - 1;
+            if (first < 1 || last + 2 > path.size() || !CanMoveBetweenPaths(a, first, last))
+                continue;
+
+            const auto before = path[first - 1];
+            const auto after = path[last + 1];
+            const auto segmentCost = GetSegmentCost(a, first, last);
+
+            // the segment (s0, ..., s1) replaces the segment (t0, ..., t1) in path b and vice versa
+            const auto evaluate = [&](size_t b, size_t firstB, size_t lastB)
+            {
+                const auto& pathB = m_paths[b];
+                if (firstB < 1 || lastB + 2 > pathB.size()
+                    || !CanMoveBetweenPaths(b, firstB, lastB))
+                    return;
+
+                const auto beforeB = pathB[firstB - 1];
+                const auto afterB = pathB[lastB + 1];
+                const auto segmentCostB = GetSegmentCost(b, firstB, lastB);
+
+                const auto lengthA = GetPathLength(a) - m_weights(before, path[first])
+                    - segmentCost - m_weights(path[last], after) + m_weights(before, pathB[firstB])
+                    + segmentCostB + m_weights(pathB[lastB], after);
+                const auto lengthB = GetPathLength(b) - m_weights(beforeB, pathB[firstB])
+                    - segmentCostB - m_weights(pathB[lastB], afterB)
+                    + m_weights(beforeB, path[first]) + segmentCost + m_weights(path[last], afterB);
+
+                const auto value = EvaluateBetweenPaths<mode>(a, lengthA, b, lengthB);
+                if (value.Paths < -epsilon && IsBetter(value, best.Value))
+                    best = { value, first, last, b, firstB, lastB };
+            };
+
+            for (size_t segmentLengthB = 1; segmentLengthB <= maxOrOptSegmentLength;
+                 ++segmentLengthB)
+            {
+                // new arc (c, s0), the segment of b starts behind c
+                for (const auto c : m_neighborLists.GetIncomingSpan(path[first]))
+                {
+                    if (IsInPath(c) && m_node2Agent[c] != a)
+                    {
+                        const auto firstB = m_node2Position[c] + 1;
+                        evaluate(m_node2Agent[c], firstB, firstB + segmentLengthB - 1);
+                    }
+                }
+
+                // new arc (s1, d), the segment of b ends in front of d
+                for (const auto d : m_neighborLists.GetOutgoingSpan(path[last]))
+                {
+                    if (IsInPath(d) && m_node2Agent[d] != a
+                        && m_node2Position[d] > segmentLengthB)
+                    {
+                        const auto lastB = m_node2Position[d] - 1;
+                        evaluate(m_node2Agent[d], lastB + 1 - segmentLengthB, lastB);
+                    }
+                }
+            }
+        }
+    }
+
+    if (best.Value.Paths >= -epsilon)
+        return false;
+
+    ExchangeSegments(a, best.First, best.Last + 1, best.B, best.FirstB, best.LastB + 1);
+    return true;
+}
+
+template <typename Weights>
+bool LocalSearch<Weights>::TryLinKernighan(size_t n)
+{
+    const auto a = m_node2Agent[n];
+    const auto& path = m_paths[a];
+    const auto i = m_node2Position[n];
+
+    // n = t1 stays in place, its successor t2 changes with every step
+    if (i + 3 >= path.size())
+        return false;
+
+    const auto initialLength = GetPathLength(a);
+    std::vector<size_t> lasts;
+    std::vector<size_t> touchedNodes;
+
+    double bestDelta = -epsilon;
+    size_t bestDepth = 0;
+
+    while (lasts.size() < maxLinKernighanDepth)
+    {
+        const auto t2 = path[i + 1];
+
+        // gain of the chain so far with the closing arc (t1, t2) removed
+        const auto openGain = initialLength - GetPathLength(a) + m_weights(n, t2);
+
+        // Replace (t1, t2) and (t4, t3) by (t1, t4) and (t2, t3) by reversing t2, ..., t4. Nodes
+        // touched by the chain are never chosen as t3, so added arcs are not removed again.
+        auto bestScore = std::numeric_limits<double>::lowest();
+        size_t bestT3Position = 0;
+        for (const auto t3 : m_neighborLists.GetOutgoingSpan(t2))
+        {
+            if (m_node2Agent[t3] != a || m_node2Position[t3] < i + 3
+                || m_node2Position[t3] >= path.size()
+                || std::find(touchedNodes.begin(), touchedNodes.end(), t3) != touchedNodes.end())
+                continue;
+
+            const auto k = m_node2Position[t3];
+            const auto score = m_weights(path[k - 1], t3) - m_weights(t2, t3);
+            if (openGain - m_weights(t2, t3) > epsilon && score > bestScore
+                && CanReverse(a, i + 1, k - 1))
+            {
+                bestScore = score;
+                bestT3Position = k;
+            }
+        }
+
+        if (bestT3Position == 0)
+            break;
+
+        touchedNodes.insert(
+            touchedNodes.end(), { t2, path[bestT3Position - 1], path[bestT3Position] });
+        lasts.push_back(bestT3Position - 1);
+        Flip(a, i + 1, bestT3Position - 1);
+
+        if (GetPathLength(a) - initialLength < bestDelta)
+        {
+            bestDelta = GetPathLength(a) - initialLength;
+            bestDepth = lasts.size();
+        }
+    }
+
+    // undo the steps behind the best one
+    for (; lasts.size() > bestDepth; lasts.pop_back())
+        Flip(a, i + 1, lasts.back());
+
+    if (bestDepth == 0)
+        return false;
+
+    Activate(n);
+    for (size_t k = 0; k < 3 * bestDepth; ++k)
+        Activate(touchedNodes[k]);
+
+    return true;
+}
+
+template <typename Weights>
+bool LocalSearch<Weights>::CanRelocate(size_t a, size_t first, size_t last, size_t after) const
+{
+    if (m_dependencies.IsEmpty())
+        return true;
+
+    const auto& path = m_paths[a];
+
+    for (auto k = first; k <= last; ++k)
+    {
+        if (after > last)
+        {
+            // segment is moved behind the nodes (last, after], none of them may depend on it
+            for (const auto w : m_dependencies.GetOutgoingSpan(path[k]))
+            {
+                if (m_node2Agent[w] == a && m_node2Position[w] > last
+                    && m_node2Position[w] <= after)
+                    return false;
+            }
+        }
+        else
+        {
+            // segment is moved in front of the nodes (after, first), it may not depend on them
+            for (const auto w : m_dependencies.GetIncomingSpan(path[k]))
+            {
+                if (m_node2Agent[w] == a && m_node2Position[w] > after
+                    && m_node2Position[w] < first)
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template <typename Weights>
+bool LocalSearch<Weights>::CanReverse(size_t a, size_t first, size_t last) const
+{
+    if (m_dependencies.IsEmpty())
+        return true;
+
+    const auto& path = m_paths[a];
+
+    for (auto k = first; k <= last; ++k)
+    {
+        for (const auto w : m_dependencies.GetOutgoingSpan(path[k]))
+        {
+            if (m_node2Agent[w] == a && m_node2Position[w] >= first
+                && m_node2Position[w] <= last)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename Weights>
+bool LocalSearch<Weights>::CanMoveBetweenPaths(size_t a, size_t first, size_t last) const
+{
+    // all nodes connected by dependencies have to stay in the same path
+    for (auto k = first; k <= last; ++k)
+    {
+        const auto n = m_paths[a][k];
+        if (!m_dependencies.GetIncomingSpan(n).empty()
+            || !m_dependencies.GetOutgoingSpan(n).empty())
+            return false;
+    }
+
+    return true;
+}
+
+template <typename Weights>
+template <OptimizationMode mode>
+typename LocalSearch<Weights>::MoveValue LocalSearch<Weights>::EvaluateBetweenPaths(
+    size_t a, double lengthA, size_t b, double lengthB) const
+{
+    const auto oldLengthA = GetPathLength(a);
+    const auto oldLengthB = GetPathLength(b);
+
+    if constexpr (mode == OptimizationMode::Sum)
+    {
+        const auto delta = lengthA + lengthB - oldLengthA - oldLengthB;
+        return { delta, delta };
+    }
+    else
+    {
+        const auto others = m_pathLengths.GetLongestLengthExcluding(a, b);
+        const auto newObjective = std::max({ others, lengthA, lengthB });
+        return { newObjective - m_pathLengths.GetLongestLength(),
+                 std::max(lengthA, lengthB) - std::max(oldLengthA, oldLengthB) };
+    }
+}
+
+template <typename Weights>
+bool LocalSearch<Weights>::IsBetter(const MoveValue& lhs, const MoveValue& rhs)
+{
+    if (lhs.Objective < rhs.Objective - epsilon)
+        return true;
+
+    return lhs.Objective <= rhs.Objective + epsilon && lhs.Paths < rhs.Paths;
+}
+
+template <typename Weights>
+double LocalSearch<Weights>::GetPathLength(size_t a) const
+{
+    return m_forwardCosts[a].empty() ? 0.0 : m_forwardCosts[a].back();
+}
+
+template <typename Weights>
+double LocalSearch<Weights>::GetSegmentCost(size_t a, size_t first, size_t last) const
+{
+    return m_forwardCosts[a][last] - m_forwardCosts[a][first];
+}
+
+template <typename Weights>
+double LocalSearch<Weights>::GetReversedSegmentCost(size_t a, size_t first, size_t last) const
+{
+    return m_backwardCosts[a][last] - m_backwardCosts[a][first];
+}
+
+template <typename Weights>
+void LocalSearch<Weights>::Relocate(
+    size_t a, size_t first, size_t last, size_t after, bool isReversed)
+{
+    auto& path = m_paths[a];
+
+    for (const auto k : { first - 1, first, last, last + 1, after, after + 1 })
+        Activate(path[k]);
+
+    using DiffT = std::vector<size_t>::difference_type;
+    const auto it = [&](size_t k) { return path.begin() + static_cast<DiffT>(k); };
+
+    if (after > last)
+    {
+        std::rotate(it(first), it(last + 1), it(after + 1));
+        if (isReversed)
+            std::reverse(it(after + first - last), it(after + 1));
+        Update(a, first, after);
+    }
+    else
+    {
+        std::rotate(it(after + 1), it(first), it(last + 1));
+        if (isReversed)
+            std::reverse(it(after + 1), it(after + 2 + last - first));
+        Update(a, after + 1, last);
+    }
+}
+
+template <typename Weights>
+void LocalSearch<Weights>::Reverse(size_t a, size_t first, size_t last)
+{
+    auto& path = m_paths[a];
+
+    for (const auto k : { first - 1, first, last, last + 1 })
+        Activate(path[k]);
+
+    Flip(a, first, last);
+}
+
+template <typename Weights>
+void LocalSearch<Weights>::Flip(size_t a, size_t first, size_t last)
+{
+    auto& path = m_paths[a];
+
+    using DiffT = std::vector<size_t>::difference_type;
+    std::reverse(
+        path.begin() + static_cast<DiffT>(first), path.begin() + static_cast<DiffT>(last + 1));
+    Update(a, first, last);
+}
+
+template <typename Weights>
+void LocalSearch<Weights>::ExchangeSegments(
+    size_t a, size_t firstA, size_t endA, size_t b, size_t firstB, size_t endB)
+{
+    auto& pathA = m_paths[a];
+    auto& pathB = m_paths[b];
+
+    using DiffT = std::vector<size_t>::difference_type;
+    const auto it = [](std::vector<size_t>& path, size_t k)
+    { return path.begin() + static_cast<DiffT>(k); };
+
+    const std::vector<size_t> segmentA(it(pathA, firstA), it(pathA, endA));
+    const std::vector<size_t> segmentB(it(pathB, firstB), it(pathB, endB));
+
+    for (const auto n : segmentA)
+        m_node2Agent[n] = b;
+    for (const auto n : segmentB)
+        m_node2Agent[n] = a;
+
+    pathA.erase(it(pathA, firstA), it(pathA, endA));
+    pathA.insert(it(pathA, firstA), segmentB.begin(), segmentB.end());
+    pathB.erase(it(pathB, firstB), it(pathB, endB));
+    pathB.insert(it(pathB, firstB), segmentA.begin(), segmentA.end());
+
+    Update(a, firstA, pathA.size() - 1);
+    Update(b, firstB, pathB.size() - 1);
+
+    for (auto k = firstA - 1; k <= firstA + segmentB.size(); ++k)
+        Activate(pathA[k]);
+    for (auto k = firstB - 1; k <= firstB + segmentA.size(); ++k)
+        Activate(pathB[k]);
+
+    // the longest path might be improvable by a move to one of the paths that got shorter now
+    if (m_optimizationMode == OptimizationMode::Max)
+    {
+        for (const auto n : m_paths[m_pathLengths.GetLongestPath()])
+            Activate(n);
+    }
+}
+
+template <typename Weights>
+void LocalSearch<Weights>::Update(size_t a, size_t first, size_t last)
+{
+    const auto& path = m_paths[a];
+
+    for (auto k = first; k <= last; ++k)
+        m_node2Position[path[k]] = k;
+
+    // the cumulative costs of all following positions change as well
+    auto& forward = m_forwardCosts[a];
+    auto& backward = m_backwardCosts[a];
+    forward.resize(path.size());
+    backward.resize(path.size());
+    for (auto k = std::max(first, static_cast<size_t>(1)); k < path.size(); ++k)
+    {
+        forward[k] = forward[k - 1] + m_weights(path[k - 1], path[k]);
+        backward[k] = backward[k - 1] + m_weights(path[k], path[k - 1]);
+    }
+
+    m_pathLengths.Update(a, GetPathLength(a));
+}
+
+template <typename Weights>
+void LocalSearch<Weights>::Activate(size_t n)
+{
+    if (!IsInPath(n) || m_isActive[n])
+        return;
+
+    m_isActive[n] = true;
+    m_activeNodes.push_back(n);
+}
+
+template class LocalSearch<WeightsView>;
+template class LocalSearch<CoordinateWeights>;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "CoordinateWeights.hpp"
+#include "MtspModel.hpp"
+#include "PathLengthHeap.hpp"
+#include "WeightsView.hpp"
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace tsplp
+{
+class DependencyGraph;
+class NeighborLists;
+
+// Improves paths with fixed start and end nodes by Or-opt moves (relocation of segments of up to
+// three nodes, optionally reversed) and 2-opt moves (reversal of a segment). Moves are only
+// generated for the nearest neighbors of a node. A node is only examined again after one of its
+// adjacent arcs has changed since its last unsuccessful examination (don't-look bits).
+// Each path keeps the cumulative costs of traversing it forwards and backwards, so the cost of a
+// reversed segment is known in O(1) even for asymmetric weights.
+// Nodes without dependencies can also change paths, either by relocating a segment to another path
+// or by exchanging segments of up to three nodes between two paths (CROSS exchange, which includes
+// swapping two single nodes). In Max mode, such a move must shorten the longer of the two involved
+// paths, and among those, moves that shorten the longest path overall are preferred.
+// If none of these moves improves, a Lin-Kernighan style variable-depth search chains reversals
+// anchored at a node, as long as the partial gain stays positive, and keeps the best prefix of the
+// chain.
+// Run dispatches on the optimization mode once, so the evaluation of the moves between paths does
+// not branch on it.
+// Instantiated for WeightsView and CoordinateWeights.
+template <typename Weights>
+class LocalSearch
+{
+private:
+    OptimizationMode m_optimizationMode;
+    Weights m_weights;
+    const DependencyGraph& m_dependencies;
+    const NeighborLists& m_neighborLists;
+
+    std::vector<std::vector<size_t>> m_paths;
+    std::vector<std::vector<double>> m_forwardCosts;
+    std::vector<std::vector<double>> m_backwardCosts;
+    PathLengthHeap m_pathLengths;
+    std::vector<size_t> m_node2Agent;
+    std::vector<size_t> m_node2Position;
+
+    std::deque<size_t> m_activeNodes;
+    std::vector<bool> m_isActive;
+
+public:
+    LocalSearch(
+        OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths, Weights weights,
+        const DependencyGraph& dependencies, const NeighborLists& neighborLists);
+
+    // Returns the improvement of the objective.
+    double Run(std::chrono::steady_clock::time_point endTime);
+
+    [[nodiscard]] const auto& GetPaths() const { return m_paths; }
+    [[nodiscard]] std::vector<std::vector<size_t>> ExtractPaths() { return std::move(m_paths); }
+    [[nodiscard]] double GetObjective() const;
+
+private:
+    // Change of the objective and of the combined (Sum) or maximum (Max) length of the two paths
+    // involved in a move between paths.
+    struct MoveValue
+    {
+        double Objective = 0.0;
+        double Paths = 0.0;
+    };
+
+    template <OptimizationMode mode>
+    void Improve(std::chrono::steady_clock::time_point endTime);
+
+    bool TryOrOpt(size_t n);
+    bool TryTwoOpt(size_t n);
+    template <OptimizationMode mode>
+    bool TryRelocateBetweenPaths(size_t n);
+    template <OptimizationMode mode>
+    bool TryCrossExchange(size_t n);
+    bool TryLinKernighan(size_t n);
+
+    [[nodiscard]] bool IsInPath(size_t n) const { return m_node2Agent[n] < m_paths.size(); }
+
+    [[nodiscard]] bool CanRelocate(size_t a, size_t first, size_t last, size_t after) const;
+    [[nodiscard]] bool CanReverse(size_t a, size_t first, size_t last) const;
+    [[nodiscard]] bool CanMoveBetweenPaths(size_t a, size_t first, size_t last) const;
+
+    template <OptimizationMode mode>
+    [[nodiscard]] MoveValue EvaluateBetweenPaths(
+        size_t a, double lengthA, size_t b, double lengthB) const;
+    [[nodiscard]] static bool IsBetter(const MoveValue& lhs, const MoveValue& rhs);
+
+    [[nodiscard]] double GetPathLength(size_t a) const;
+    [[nodiscard]] double GetSegmentCost(size_t a, size_t first, size_t last) const;
+    [[nodiscard]] double GetReversedSegmentCost(size_t a, size_t first, size_t last) const;
+
+    void Relocate(size_t a, size_t first, size_t last, size_t after, bool isReversed);
+    void Reverse(size_t a, size_t first, size_t last);
+    void Flip(size_t a, size_t first, size_t last);
+    // Segments are given as half-open ranges, the one of b may be empty.
+    void ExchangeSegments(
+        size_t a, size_t firstA, size_t endA, size_t b, size_t firstB, size_t endB);
+    void Update(size_t a, size_t first, size_t last);
+
+    void Activate(size_t n);
+};
+}
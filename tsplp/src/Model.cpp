@@ -4,6 +4,7 @@
 #include "LinearVariableComposition.hpp"
 
 #include <ClpSimplex.hpp>
+#include <CoinPackedMatrix.hpp>
 
 #include <boost/range/iterator_range.hpp>
 
@@ -40,6 +41,8 @@ tsplp::Model::Model(const Model& other)
     , m_spModelMutex { std::make_unique<std::mutex>() }
     , m_variables(other.m_variables)
     , m_numberOfBinaryVariables(other.m_numberOfBinaryVariables)
+    , m_columns(other.m_columns)
+    , m_removedValues(other.m_removedValues)
 {
 }
 
@@ -48,6 +51,8 @@ tsplp::Model::Model(Model&& other) noexcept
     , m_spModelMutex(std::move(other.m_spModelMutex))
     , m_variables(std::move(other.m_variables))
     , m_numberOfBinaryVariables(other.m_numberOfBinaryVariables)
+    , m_columns(std::move(other.m_columns))
+    , m_removedValues(std::move(other.m_removedValues))
 {
 }
 
@@ -67,10 +72,16 @@ void tsplp::Model::SetObjective(const LinearVariableComposition& objective)
 {
     std::unique_lock lock { *m_spModelMutex };
 
-    m_spSimplexModel->setObjectiveOffset(-objective.GetConstant()); // offset is negative
-
+    auto constant = objective.GetConstant();
     for (const auto& [varId, coef] : objective.GetVariableIdCoefficientMap())
-        m_spSimplexModel->setObjectiveCoefficient(static_cast<int>(varId), coef);
+    {
+        if (const auto column = m_columns[varId]; column >= 0)
+            m_spSimplexModel->setObjectiveCoefficient(column, coef);
+        else
+            constant += coef * m_removedValues[varId];
+    }
+
+    m_spSimplexModel->setObjectiveOffset(-constant); // offset is negative
 }
 
 template <typename RandIterator>
@@ -93,17 +104,26 @@ void tsplp::Model::AddConstraints(RandIterator first, RandIterator last)
     std::vector<double> elements;
     for (const auto& c : boost::make_iterator_range(first, last))
     {
-        lowerBounds.push_back(c.GetLowerBound());
-        upperBounds.push_back(c.GetUpperBound());
-
-        rowStarts.push_back(
-            rowStarts.back() + static_cast<int>(std::ssize(c.GetVariableIdCoefficientMap())));
+        auto lowerBound = c.GetLowerBound();
+        auto upperBound = c.GetUpperBound();
 
         for (const auto& [varId, coef] : c.GetVariableIdCoefficientMap())
         {
-            elements.push_back(coef);
-            columns.push_back(static_cast<int>(varId));
+            if (const auto column = m_columns[varId]; column >= 0)
+            {
+                elements.push_back(coef);
+                columns.push_back(column);
+            }
+            else
+            {
+                lowerBound -= coef * m_removedValues[varId];
+                upperBound -= coef * m_removedValues[varId];
+            }
         }
+
+        lowerBounds.push_back(lowerBound);
+        upperBounds.push_back(upperBound);
+        rowStarts.push_back(static_cast<int>(columns.size()));
     }
 
     std::unique_lock lock { *m_spModelMutex };
@@ -123,9 +143,15 @@ template void tsplp::Model::AddConstraints(
 
 tsplp::Variable tsplp::Model::AddVariable(double lowerBound, double upperBound)
 {
+    // the constructor adds the columns of all binary variables at once
+    if (m_variables.size() >= m_numberOfBinaryVariables)
+        m_spSimplexModel->addColumn(0, nullptr, nullptr);
+
+    m_columns.push_back(
+        m_variables.size() < m_numberOfBinaryVariables ? static_cast<int>(m_variables.size())
+                                                        : m_spSimplexModel->getNumCols() - 1);
+    m_removedValues.push_back(0.0);
     m_variables.emplace_back(m_variables.size());
-    if (m_variables.size() >= static_cast<size_t>(m_spSimplexModel->getNumCols()))
-        m_spSimplexModel->addColumn(m_spSimplexModel->getNumCols(), nullptr, nullptr);
 
     m_variables.back().SetLowerBound(lowerBound, *this);
     m_variables.back().SetUpperBound(upperBound, *this);
@@ -158,6 +184,119 @@ tsplp::Status tsplp::Model::Solve(std::chrono::steady_clock::time_point endTime)
     }
 }
 
+size_t tsplp::Model::Compact()
+{
+    constexpr double tolerance = 1.e-9;
+
+    std::unique_lock lock { *m_spModelMutex };
+
+    const auto numberOfRows = static_cast<size_t>(m_spSimplexModel->getNumRows());
+    const auto numberOfColumns = static_cast<size_t>(m_spSimplexModel->getNumCols());
+    const std::span columnLower(m_spSimplexModel->getColLower(), numberOfColumns);
+    const std::span columnUpper(m_spSimplexModel->getColUpper(), numberOfColumns);
+    const std::span objective(m_spSimplexModel->getObjCoefficients(), numberOfColumns);
+
+    // column-ordered
+    const auto& matrix = *m_spSimplexModel->matrix();
+    const std::span starts(matrix.getVectorStarts(), numberOfColumns);
+    const std::span lengths(matrix.getVectorLengths(), numberOfColumns);
+    const std::span indices(matrix.getIndices(), static_cast<size_t>(matrix.getNumElements()));
+    const std::span elements(matrix.getElements(), static_cast<size_t>(matrix.getNumElements()));
+
+    std::vector<bool> isRemoved(numberOfColumns, false);
+    for (size_t id = 0; id < m_numberOfBinaryVariables; ++id)
+    {
+        if (const auto column = static_cast<size_t>(m_columns[id]);
+            m_columns[id] >= 0 && columnLower[column] == columnUpper[column])
+        {
+            isRemoved[column] = true;
+        }
+    }
+
+    const std::span originalRowLower(m_spSimplexModel->getRowLower(), numberOfRows);
+    const std::span originalRowUpper(m_spSimplexModel->getRowUpper(), numberOfRows);
+    std::vector<double> rowLower(originalRowLower.begin(), originalRowLower.end());
+    std::vector<double> rowUpper(originalRowUpper.begin(), originalRowUpper.end());
+    auto offset = m_spSimplexModel->objectiveOffset();
+
+    // the range of each row's activity over the remaining columns
+    std::vector<double> minActivity(numberOfRows, 0.0);
+    std::vector<double> maxActivity(numberOfRows, 0.0);
+
+    std::vector<int> removedColumns;
+    std::vector<int> newColumns(numberOfColumns, -1);
+    for (size_t column = 0; column < numberOfColumns; ++column)
+    {
+        const auto start = static_cast<size_t>(starts[column]);
+        const auto end = start + static_cast<size_t>(lengths[column]);
+        for (auto k = start; k < end; ++k)
+        {
+            const auto row = static_cast<size_t>(indices[k]);
+            const auto element = elements[k];
+
+            if (isRemoved[column])
+            {
+                rowLower[row] -= element * columnLower[column];
+                rowUpper[row] -= element * columnLower[column];
+            }
+            else
+            {
+                minActivity[row]
+                    += element * (element > 0 ? columnLower[column] : columnUpper[column]);
+                maxActivity[row]
+                    += element * (element > 0 ? columnUpper[column] : columnLower[column]);
+            }
+        }
+
+        if (isRemoved[column])
+        {
+            offset -= objective[column] * columnLower[column];
+            removedColumns.push_back(static_cast<int>(column));
+        }
+        else
+        {
+            newColumns[column] = static_cast<int>(column - removedColumns.size());
+        }
+    }
+
+    std::vector<int> removedRows;
+    for (size_t row = 0; row < numberOfRows; ++row)
+    {
+        if (minActivity[row] >= rowLower[row] - tolerance
+            && maxActivity[row] <= rowUpper[row] + tolerance)
+        {
+            removedRows.push_back(static_cast<int>(row));
+        }
+        else
+        {
+            m_spSimplexModel->setRowLower(static_cast<int>(row), rowLower[row]);
+            m_spSimplexModel->setRowUpper(static_cast<int>(row), rowUpper[row]);
+        }
+    }
+
+    for (size_t id = 0; id < m_variables.size(); ++id)
+    {
+        if (const auto column = static_cast<size_t>(m_columns[id]);
+            m_columns[id] >= 0 && isRemoved[column])
+        {
+            m_removedValues[id] = columnLower[column];
+        }
+    }
+
+    m_spSimplexModel->setObjectiveOffset(offset);
+    m_spSimplexModel->deleteRows(static_cast<int>(removedRows.size()), removedRows.data());
+    m_spSimplexModel->deleteColumns(
+        static_cast<int>(removedColumns.size()), removedColumns.data());
+
+    for (auto& column : m_columns)
+    {
+        if (column >= 0)
+            column = newColumns[static_cast<size_t>(column)];
+    }
+
+    return removedColumns.size();
+}
+
 void tsplp::swap(tsplp::Model& m1, tsplp::Model& m2) noexcept
 {
     using std::swap;
@@ -166,4 +305,6 @@ void tsplp::swap(tsplp::Model& m1, tsplp::Model& m2) noexcept
     swap(m1.m_spModelMutex, m2.m_spModelMutex);
     swap(m1.m_variables, m2.m_variables);
     swap(m1.m_numberOfBinaryVariables, m2.m_numberOfBinaryVariables);
+    swap(m1.m_columns, m2.m_columns);
+    swap(m1.m_removedValues, m2.m_removedValues);
 }
@@ -1,20 +1,26 @@
 #include "MtspModel.hpp"
 
+#include "ArcDomains.hpp"
 #include "BranchAndCutQueue.hpp"
 #include "ConstraintDeque.hpp"
+#include "HeldKarp.hpp"
 #include "Heuristics.hpp"
 #include "LinearConstraint.hpp"
 #include "SeparationAlgorithms.hpp"
+#include "SolutionMailbox.hpp"
 
 #include <xtensor/xadapt.hpp>
 #include <xtensor/xvectorize.hpp>
 #include <xtensor/xview.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <limits>
+#include <memory>
 #include <mutex>
+#include <random>
 #include <stdexcept>
 #include <thread>
 
@@ -32,6 +38,35 @@ void UnfixVariables(std::span<const tsplp::Variable> variables, tsplp::Model& mo
         v.Unfix(model);
 }
 
+// Fixes the variables whose domains are reduced to a single value but which are not fixed in the
+// model yet, and appends them to the fixed variables.
+void FixImpliedVariables(
+    const tsplp::ArcDomains& domains, const xt::xtensor<tsplp::Variable, 3>& X,
+    std::vector<tsplp::Variable>& fixedVariables0, std::vector<tsplp::Variable>& fixedVariables1,
+    tsplp::Model& model)
+{
+    for (size_t a = 0; a < X.shape(0); ++a)
+    {
+        for (size_t u = 0; u < X.shape(1); ++u)
+        {
+            for (size_t v = 0; v < X.shape(2); ++v)
+            {
+                const auto x = X(a, u, v);
+                if (!domains.IsPossible(a, u, v) && x.GetUpperBound(model) > 0.5)
+                {
+                    x.Fix(0.0, model);
+                    fixedVariables0.push_back(x);
+                }
+                else if (domains.IsFixedToOne(a, u, v) && x.GetLowerBound(model) < 0.5)
+                {
+                    x.Fix(1.0, model);
+                    fixedVariables1.push_back(x);
+                }
+            }
+        }
+    }
+}
+
 std::optional<tsplp::Variable> FindFractionalVariable(
     const tsplp::Model& model, double epsilon = 1.e-10)
 {
@@ -53,12 +88,270 @@ std::optional<tsplp::Variable> FindFractionalVariable(
 
     return closest;
 }
+
+// Every node except the start nodes is entered once and every node except the end nodes is left
+// once, so the sum of the cheapest entering arcs and the sum of the cheapest leaving arcs are both
+// lower bounds of Sum. The longest path is at least as long as the average one. Needs O(N^2)
+// instead of solving an LP.
+double CalculateDegreeLowerBound(
+    const tsplp::WeightManager& weightManager, tsplp::OptimizationMode optimizationMode)
+{
+    const auto& weights = weightManager.W();
+    const auto N = weightManager.N();
+
+    std::vector<bool> isStart(N, false);
+    std::vector<bool> isEnd(N, false);
+    for (const auto s : weightManager.StartPositions())
+        isStart[s] = true;
+    for (const auto e : weightManager.EndPositions())
+        isEnd[e] = true;
+
+    // reverse arcs of dependencies (-1) are never used, and neither is the arc from start to end
+    // if a single agent has to visit all other nodes
+    const auto isUnused = [&](size_t u, size_t v)
+    {
+        return weights(u, v) == -1
+            || (weightManager.A() == 1 && N > 2 && u == weightManager.StartPositions()[0]
+                && v == weightManager.EndPositions()[0]);
+    };
+
+    double entering = 0.0;
+    double leaving = 0.0;
+    for (size_t n = 0; n < N; ++n)
+    {
+        auto cheapestEntering = std::numeric_limits<double>::max();
+        auto cheapestLeaving = std::numeric_limits<double>::max();
+        for (size_t m = 0; m < N; ++m)
+        {
+            if (m == n)
+                continue;
+
+            if (!isEnd[m] && !isUnused(m, n))
+                cheapestEntering = std::min(cheapestEntering, weights(m, n));
+            if (!isStart[m] && !isUnused(n, m))
+                cheapestLeaving = std::min(cheapestLeaving, weights(n, m));
+        }
+
+        if (!isStart[n] && cheapestEntering < std::numeric_limits<double>::max())
+            entering += cheapestEntering;
+        if (!isEnd[n] && cheapestLeaving < std::numeric_limits<double>::max())
+            leaving += cheapestLeaving;
+    }
+
+    const auto sumBound = std::max(entering, leaving);
+    return optimizationMode == tsplp::OptimizationMode::Sum
+        ? sumBound
+        : sumBound / static_cast<double>(weightManager.A());
+}
+
+// Nodes that can be moved to any position of any path without violating dependencies.
+std::vector<size_t> FindMovableNodes(const tsplp::WeightManager& weightManager)
+{
+    const auto& startPositions = weightManager.StartPositions();
+    const auto& endPositions = weightManager.EndPositions();
+
+    std::vector<size_t> movableNodes;
+    for (size_t n = 0; n < weightManager.N(); ++n)
+    {
+        const auto isTerminal
+            = std::find(startPositions.begin(), startPositions.end(), n) != startPositions.end()
+            || std::find(endPositions.begin(), endPositions.end(), n) != endPositions.end();
+
+        if (!isTerminal && weightManager.Dependencies().GetIncomingSpan(n).empty()
+            && weightManager.Dependencies().GetOutgoingSpan(n).empty())
+        {
+            movableNodes.push_back(n);
+        }
+    }
+
+    return movableNodes;
+}
+
+// Moves a few random nodes to random positions, as a perturbation that local search does not
+// simply undo. The nodes must not have dependencies.
+std::vector<std::vector<size_t>> PerturbPaths(
+    std::vector<std::vector<size_t>> paths, std::span<const size_t> movableNodes,
+    std::mt19937_64& generator)
+{
+    constexpr size_t perturbedNodes = 8;
+
+    for (size_t i = 0; i < std::min(perturbedNodes, movableNodes.size()); ++i)
+    {
+        const auto n = movableNodes[generator() % movableNodes.size()];
+        for (auto& path : paths)
+        {
+            if (const auto it = std::find(path.begin() + 1, path.end() - 1, n);
+                it != path.end() - 1)
+            {
+                path.erase(it);
+                break;
+            }
+        }
+
+        auto& path = paths[generator() % paths.size()];
+        const auto position = 1 + generator() % (path.size() - 1);
+        path.insert(path.begin() + static_cast<std::ptrdiff_t>(position), n);
+    }
+
+    return paths;
+}
+
+// The shortest path through the given nodes from the first to the last one, found by a single
+// agent MtspModel until endTime. Its result may be the heuristic one, or empty if there is none.
+// The callers solve many of them in parallel, so each one runs on a single thread.
+std::vector<size_t> SolveSinglePath(
+    const std::vector<size_t>& nodes, const xt::xtensor<double, 2>& weights,
+    std::chrono::steady_clock::time_point endTime, const std::string& name)
+{
+    const auto M = nodes.size();
+
+    // the sub-model numbers the nodes by their position, so the first and last node are distinct
+    // even if the path is closed
+    auto subWeights = xt::xtensor<double, 2>::from_shape({ M, M });
+    for (size_t k = 0; k < M; ++k)
+    {
+        for (size_t l = 0; l < M; ++l)
+            subWeights(k, l) = weights(nodes[k], nodes[l]);
+    }
+
+    const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+        endTime - std::chrono::steady_clock::now());
+    if (timeout <= std::chrono::milliseconds::zero())
+        return {};
+
+    // for a single path, Sum and Max are the same
+    tsplp::MtspModel model(
+        xt::xtensor<size_t, 1> { 0 }, xt::xtensor<size_t, 1> { M - 1 }, std::move(subWeights),
+        tsplp::OptimizationMode::Sum, timeout, name, 1);
+    model.BranchAndCutSolve(1);
+
+    const auto& result = model.GetResult();
+    if (result.GetPaths().empty())
+        return {};
+
+    std::vector<size_t> path;
+    for (const auto k : result.GetPaths()[0])
+        path.push_back(nodes[k]);
+
+    return path;
+}
+
+// A single agent without dependencies on symmetric weights, where the direction of the path does
+// not matter. The artificial arc from end to start is exempt, as it becomes an edge of weight 0.
+// With only two nodes, the only edge cannot give both of them degree 2.
+bool IsUndirected(const tsplp::WeightManager& weightManager)
+{
+    if (weightManager.A() != 1 || weightManager.N() <= 2
+        || !weightManager.Dependencies().GetArcs().empty())
+    {
+        return false;
+    }
+
+    const auto& weights = weightManager.W();
+    const auto N = weightManager.N();
+    const auto s = weightManager.StartPositions()[0];
+    const auto e = weightManager.EndPositions()[0];
+
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < u; ++v)
+        {
+            if (weights(u, v) != weights(v, u) && std::minmax(s, e) != std::minmax(u, v))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// In the undirected LP, X(0, u, v) and X(0, v, u) share the column of the edge, so each arc gets
+// half of its value, which keeps the degrees of the directed formulation.
+xt::xtensor<double, 3> ArcValues(xt::xtensor<double, 3> values, bool isUndirected)
+{
+    if (isUndirected)
+    {
+        for (auto& value : values)
+            value *= 0.5;
+    }
+
+    return values;
+}
+
+// The separation algorithms in the order in which branch and cut tries them.
+constexpr size_t NumberOfSeparationAlgorithms = 5;
+
+// The cut loops at the root stop if the objective improved by less than TailOffImprovement, as a
+// fraction of it, within the last TailOffRounds rounds.
+constexpr size_t TailOffRounds = 5;
+constexpr double TailOffImprovement = 1.e-3;
+
+// Every thread dives from its first exploitable node and from every DivingInterval-th exploitable
+// one after that, see BranchAndCutSolve.
+constexpr size_t DivingInterval = 32;
+
+// The root model is compacted if at least this fraction of its arcs is fixed.
+constexpr double CompactionThreshold = 0.5;
+
+// Appends the free binary variables at 0 or 1 to fixedVariables0 or fixedVariables1, if their
+// reduced costs show that changing them cannot lead to a solution better than the upper bound.
+void AddReducedCostFixings(
+    const tsplp::Model& model, double lowerBound, double upperBound,
+    std::vector<tsplp::Variable>& fixedVariables0, std::vector<tsplp::Variable>& fixedVariables1)
+{
+    for (const auto v : model.GetBinaryVariables())
+    {
+        if (v.GetLowerBound(model) == 0.0 && v.GetUpperBound(model) == 1.0)
+        {
+            if (v.GetObjectiveValue(model) < 1.e-10
+                && lowerBound + v.GetReducedCosts(model) >= upperBound + 1.e-10)
+            {
+                fixedVariables0.push_back(v);
+            }
+            else if (
+                v.GetObjectiveValue(model) > 1 - 1.e-10
+                && lowerBound - v.GetReducedCosts(model) >= upperBound + 1.e-10)
+            {
+                fixedVariables1.push_back(v);
+            }
+        }
+    }
+}
+
+std::vector<tsplp::LinearConstraint> Separate(
+    const tsplp::graph::Separator& separator, size_t algorithm)
+{
+    std::optional<tsplp::LinearConstraint> constraint;
+    switch (algorithm)
+    {
+    case 0:
+        constraint = separator.Ucut();
+        break;
+    case 1:
+        constraint = separator.PiSigma();
+        break;
+    case 2:
+        constraint = separator.Pi();
+        break;
+    case 3:
+        constraint = separator.Sigma();
+        break;
+    case 4:
+        return separator.TwoMatching();
+    default:
+        throw std::logic_error("Unknown separation algorithm.");
+    }
+
+    std::vector<tsplp::LinearConstraint> constraints;
+    if (constraint.has_value())
+        constraints.push_back(std::move(*constraint));
+    return constraints;
+}
 }
 
 tsplp::MtspModel::MtspModel(
     xt::xtensor<size_t, 1> startPositions, xt::xtensor<size_t, 1> endPositions,
     xt::xtensor<double, 2> weights, OptimizationMode optimizationMode,
-    std::chrono::milliseconds timeout, std::string name)
+    std::chrono::milliseconds timeout, std::string name, std::optional<size_t> noOfThreads)
     : m_endTime(m_startTime + timeout)
     , m_weightManager(std::move(weights), std::move(startPositions), std::move(endPositions))
     , m_optimizationMode(optimizationMode)
@@ -69,7 +362,14 @@ tsplp::MtspModel::MtspModel(
     if (m_optimizationMode != OptimizationMode::Sum && m_optimizationMode != OptimizationMode::Max)
         return;
 
-    CreateInitialResult();
+    CreateInitialResult(
+        noOfThreads && *noOfThreads > 0 ? *noOfThreads : std::thread::hardware_concurrency());
+}
+
+void tsplp::MtspModel::CreateLinearProgram()
+{
+    if (m_optimizationMode != OptimizationMode::Sum && m_optimizationMode != OptimizationMode::Max)
+        return;
 
     if (std::chrono::steady_clock::now() >= m_endTime)
     {
@@ -77,16 +377,54 @@ tsplp::MtspModel::MtspModel(
         return;
     }
 
-    m_model = Model(A * N * N);
-    X = xt::adapt(
-        m_model.GetBinaryVariables().data(), A * N * N, xt::no_ownership {},
-        std::array { A, N, N });
+    m_isUndirected = IsUndirected(m_weightManager);
+
+    if (m_isUndirected)
+    {
+        // one column per edge {u, v} with u >= v, which X(0, u, v) and X(0, v, u) share
+        m_model = Model(N * (N + 1) / 2);
+        X = xt::xtensor<Variable, 3>::from_shape({ 1, N, N });
+        for (size_t u = 0; u < N; ++u)
+        {
+            for (size_t v = 0; v <= u; ++v)
+            {
+                X(0, u, v) = m_model.GetBinaryVariables()[u * (u + 1) / 2 + v];
+                X(0, v, u) = X(0, u, v);
+            }
+        }
+    }
+    else
+    {
+        m_model = Model(A * N * N);
+        X = xt::adapt(
+            m_model.GetBinaryVariables().data(), A * N * N, xt::no_ownership {},
+            std::array { A, N, N });
+    }
 
     const auto maxVariable = m_optimizationMode == OptimizationMode::Max
         ? std::make_optional(m_model.AddVariable(0.0, std::numeric_limits<double>::max()))
         : std::nullopt;
 
-    m_objective = CreateObjective(m_weightManager.W(), X, maxVariable);
+    if (m_isUndirected)
+    {
+        // each edge is counted once, and the artificial one from end to start is free
+        auto edgeWeights = xt::xtensor<double, 2>::from_shape({ N, N });
+        edgeWeights.fill(0.0);
+        for (size_t u = 0; u < N; ++u)
+        {
+            for (size_t v = 0; v < u; ++v)
+                edgeWeights(u, v) = m_weightManager.W()(u, v);
+        }
+        const auto [s, e] = std::minmax(
+            m_weightManager.StartPositions()[0], m_weightManager.EndPositions()[0]);
+        edgeWeights(e, s) = 0.0;
+
+        m_objective = CreateObjective(edgeWeights, X, maxVariable);
+    }
+    else
+    {
+        m_objective = CreateObjective(m_weightManager.W(), X, maxVariable);
+    }
     m_model.AddConstraints(
         cbegin(m_objective.AdditionalConstraints), cend(m_objective.AdditionalConstraints));
 
@@ -107,6 +445,25 @@ tsplp::MtspModel::MtspModel(
         return;
     }
 
+    // Every node has degree 2 and the artificial edge closes the path to a cycle. Subtours are
+    // left to the separation, and cycles of length 2 are not expressible.
+    if (m_isUndirected)
+    {
+        for (size_t n = 0; n < N; ++n)
+        {
+            LinearVariableComposition degree;
+            for (size_t m = 0; m < N; ++m)
+                degree += X(0, n, m);
+            constraints.emplace_back(std::move(degree) == 2);
+        }
+
+        constraints.emplace_back(
+            X(0, m_weightManager.EndPositions()[0], m_weightManager.StartPositions()[0]) == 1);
+
+        m_model.AddConstraints(cbegin(constraints), cend(constraints));
+        return;
+    }
+
     // degree inequalities
     for (size_t n = 0; n < N; ++n)
     {
@@ -255,8 +612,58 @@ tsplp::MtspModel::MtspModel(
         }
     }
 
-    // inequalities to disallow cycles of length 2
-    for (size_t u = 0; u < N; ++u)
+    // Interchangeable agents are ordered by the lowest free node they serve, and the ones without
+    // free nodes come last. So the k-th agent of a class cannot serve the k lowest free nodes, and
+    // it serves a node only if its predecessor in the class serves a lower one. The latter is
+    // counted by one cumulative variable per node to keep the rows short.
+    const auto& startPositions = m_weightManager.StartPositions();
+    const auto& endPositions = m_weightManager.EndPositions();
+    std::vector<size_t> freeNodes;
+    for (size_t n = 0; n < N; ++n)
+    {
+        const auto isTerminal
+            = std::find(startPositions.begin(), startPositions.end(), n) != startPositions.end()
+            || std::find(endPositions.begin(), endPositions.end(), n) != endPositions.end();
+        if (!isTerminal)
+            freeNodes.push_back(n);
+    }
+
+    for (const auto& agentClass : m_weightManager.AgentClasses())
+    {
+        for (size_t k = 1; k < agentClass.size(); ++k)
+        {
+            const auto previous = agentClass[k - 1];
+            const auto a = agentClass[k];
+
+            LinearVariableComposition servedBefore;
+            for (size_t i = 0; i < freeNodes.size(); ++i)
+            {
+                LinearVariableComposition served;
+                LinearVariableComposition servedByPrevious;
+                for (size_t m = 0; m < N; ++m)
+                {
+                    served += X(a, m, freeNodes[i]);
+                    servedByPrevious += X(previous, m, freeNodes[i]);
+                }
+
+                if (i < k)
+                    constraints.push_back(std::move(served) == 0);
+                else
+                    constraints.push_back(std::move(served) <= servedBefore);
+
+                if (i + 1 < freeNodes.size())
+                {
+                    const auto count = m_model.AddVariable(0.0, static_cast<double>(i + 1));
+                    constraints.push_back(count == std::move(servedBefore) + servedByPrevious);
+                    servedBefore = count;
+                }
+            }
+        }
+    }
+
+    // inequalities to disallow cycles of length 2, unless there are only two nodes, whose cycle is
+    // the whole tour
+    for (size_t u = 0; u < N && N > 2; ++u)
     {
         for (size_t v = u + 1; v < N; ++v)
         {
@@ -281,19 +688,49 @@ tsplp::MtspModel::MtspModel(
 
 void tsplp::MtspModel::BranchAndCutSolve(
     std::optional<size_t> noOfThreads,
-    std::function<void(const xt::xtensor<double, 3>&)> fractionalCallback)
+    std::function<void(const xt::xtensor<double, 3>&)> fractionalCallback,
+    bool backgroundHeuristic, bool allowHeldKarp)
 {
     using namespace std::chrono_literals;
 
     const auto threadCount
         = noOfThreads && *noOfThreads > 0 ? *noOfThreads : std::thread::hardware_concurrency();
 
+    if (allowHeldKarp && fractionalCallback == nullptr && A == 1 && N <= MaxHeldKarpN
+        && std::chrono::steady_clock::now() < m_endTime)
+    {
+        HeldKarpSolve();
+        return;
+    }
+
+    // the LP is only needed here, so heuristic solves don't pay for it
+    CreateLinearProgram();
+
     if (std::chrono::steady_clock::now() >= m_endTime)
     {
         m_bestResult.SetTimeoutHit();
         return;
     }
 
+    // Each node propagates its fixings from the root domains. The ones of the root itself hold
+    // everywhere, so they are fixed before the threads copy the model.
+    std::optional<ArcDomains> rootDomains;
+    if (!m_isUndirected)
+    {
+        rootDomains.emplace(m_weightManager);
+        if (!rootDomains->Propagate({}, {}))
+        {
+            m_bestResult.UpdateLowerBound(std::numeric_limits<double>::max());
+            return;
+        }
+
+        std::vector<Variable> rootFixed0;
+        std::vector<Variable> rootFixed1;
+        FixImpliedVariables(*rootDomains, X, rootFixed0, rootFixed1, m_model);
+
+        RestartAtRoot(*rootDomains);
+    }
+
     auto callbackMutex = [&]() -> std::optional<std::mutex>
     {
         if (fractionalCallback != nullptr)
@@ -305,13 +742,18 @@ void tsplp::MtspModel::BranchAndCutSolve(
     queue.Push(0, {}, {});
     ConstraintDeque constraints(threadCount);
 
+    std::optional<SolutionMailbox> mailbox;
+    if (backgroundHeuristic)
+        mailbox.emplace();
+
     const auto threadLoop = [&](const size_t threadId)
     {
         auto model = m_model;
-        const graph::Separator separator(X, m_weightManager, model);
+        const graph::Separator separator(X, m_weightManager, model, m_isUndirected);
 
         std::vector<Variable> fixedVariables0 {};
         std::vector<Variable> fixedVariables1 {};
+        size_t solvedNodes = 0;
 
         while (true)
         {
@@ -361,6 +803,16 @@ void tsplp::MtspModel::BranchAndCutSolve(
             FixVariables(fixedVariables0, 0.0, model);
             FixVariables(fixedVariables1, 1.0, model);
 
+            // skip the LP if the fixings already contradict each other
+            if (rootDomains.has_value())
+            {
+                auto domains = *rootDomains;
+                if (!domains.Propagate(fixedVariables0, fixedVariables1))
+                    continue;
+
+                FixImpliedVariables(domains, X, fixedVariables0, fixedVariables1, model);
+            }
+
             constraints.PopToModel(threadId, model);
 
             const auto solutionStatus = model.Solve(m_endTime);
@@ -387,22 +839,36 @@ void tsplp::MtspModel::BranchAndCutSolve(
 
             auto currentUpperBound = m_bestResult.UpdateLowerBound(queue.GetLowerBound()).Upper;
 
-            if (2.5 * currentLowerBound > currentUpperBound || fractionalCallback != nullptr)
+            // don't exploit if there isn't a reasonable chance, 2.5 might be adjusted
+            const auto isExploitable = 2.5 * currentLowerBound > currentUpperBound;
+            if (isExploitable || fractionalCallback != nullptr)
             {
-                const xt::xtensor<double, 3> fractionalValues
+                xt::xtensor<double, 3> fractionalValues
                     = xt::vectorize([&](Variable v) { return v.GetObjectiveValue(model); })(X);
 
                 if (fractionalCallback != nullptr)
                 {
                     std::unique_lock lock { *callbackMutex };
-                    fractionalCallback(m_weightManager.TransformTensorBack(fractionalValues));
+                    fractionalCallback(m_weightManager.TransformTensorBack(
+                        ArcValues(fractionalValues, m_isUndirected)));
                 }
 
-                // don't exploit if there isn't a reasonable chance, 2.5 might be adjusted
-                if (2.5 * currentLowerBound > currentUpperBound)
+                if (isExploitable && mailbox.has_value())
+                    mailbox->Publish(std::move(fractionalValues));
+                else if (isExploitable)
                     currentUpperBound = ExploitFractionalSolution(fractionalValues);
             }
 
+            // like exploiting, diving is left to the heuristic thread if there is one
+            if (isExploitable && solvedNodes++ % DivingInterval == 0
+                && currentLowerBound < currentUpperBound)
+            {
+                if (mailbox.has_value())
+                    mailbox->PublishDive(model);
+                else
+                    currentUpperBound = Dive(model, constraints);
+            }
+
             // currentLowerBound is not necessarily the global LB, but either way there is no need
             // trying to improve it further
             if (currentLowerBound >= currentUpperBound)
@@ -412,29 +878,15 @@ void tsplp::MtspModel::BranchAndCutSolve(
             }
 
             // fix variables according to reduced costs
-            for (auto v : model.GetBinaryVariables())
+            const auto previouslyFixed1 = fixedVariables1.size();
+            AddReducedCostFixings(
+                model, currentLowerBound, currentUpperBound, fixedVariables0, fixedVariables1);
+            for (size_t i = previouslyFixed1; i < fixedVariables1.size(); ++i)
             {
-                if (v.GetLowerBound(model) == 0.0 && v.GetUpperBound(model) == 1.0)
-                {
-                    if (v.GetObjectiveValue(model) < 1.e-10
-                        && currentLowerBound + v.GetReducedCosts(model)
-                            >= currentUpperBound + 1.e-10)
-                    {
-                        fixedVariables0.push_back(v);
-                    }
-                    else if (
-                        v.GetObjectiveValue(model) > 1 - 1.e-10
-                        && currentLowerBound - v.GetReducedCosts(model)
-                            >= currentUpperBound + 1.e-10)
-                    {
-                        fixedVariables1.push_back(v);
-
-                        const auto recursivelyFixed0 = CalculateRecursivelyFixableVariables(v);
-                        fixedVariables0.insert(
-                            fixedVariables0.end(), recursivelyFixed0.begin(),
-                            recursivelyFixed0.end());
-                    }
-                }
+                const auto recursivelyFixed0
+                    = CalculateRecursivelyFixableVariables(fixedVariables1[i]);
+                fixedVariables0.insert(
+                    fixedVariables0.end(), recursivelyFixed0.begin(), recursivelyFixed0.end());
             }
 
             if (auto ucut = separator.Ucut(); ucut.has_value())
@@ -498,6 +950,10 @@ void tsplp::MtspModel::BranchAndCutSolve(
         }
     };
 
+    std::optional<std::thread> heuristicThread;
+    if (mailbox.has_value())
+        heuristicThread.emplace([&] { RunPrimalHeuristic(*mailbox, constraints); });
+
     std::vector<std::thread> threads;
     for (size_t i = 1; i < threadCount; ++i)
         threads.emplace_back(threadLoop, i);
@@ -507,6 +963,12 @@ void tsplp::MtspModel::BranchAndCutSolve(
     for (auto& thread : threads)
         thread.join();
 
+    if (heuristicThread.has_value())
+    {
+        mailbox->Close();
+        heuristicThread->join();
+    }
+
     const auto [lowerBound, upperBound] = m_bestResult.GetBounds();
     assert(lowerBound <= upperBound);
 
@@ -521,6 +983,73 @@ void tsplp::MtspModel::BranchAndCutSolve(
     }
 }
 
+void tsplp::MtspModel::RestartAtRoot(ArcDomains& rootDomains)
+{
+    const graph::Separator separator(X, m_weightManager, m_model, m_isUndirected);
+
+    // infeasibility and timeouts are left to the root node of the branch and cut tree
+    std::vector<double> objectives;
+    auto lowerBound = 0.0;
+    while (true)
+    {
+        if (m_model.Solve(m_endTime) != Status::Optimal)
+            return;
+
+        const auto objective = m_objective.Objective.Evaluate(m_model);
+        lowerBound = std::ceil(objective - 1.e-10);
+        if (lowerBound >= m_bestResult.UpdateLowerBound(lowerBound).Upper)
+            return;
+
+        objectives.push_back(objective);
+        if (objectives.size() > TailOffRounds
+            && objective - objectives[objectives.size() - 1 - TailOffRounds]
+                <= TailOffImprovement * std::abs(objective))
+        {
+            break;
+        }
+
+        std::vector<LinearConstraint> cuts;
+        for (size_t algorithm = 0; algorithm < NumberOfSeparationAlgorithms && cuts.empty();
+             ++algorithm)
+        {
+            cuts = Separate(separator, algorithm);
+        }
+
+        if (cuts.empty())
+            break;
+
+        m_model.AddConstraints(cuts.cbegin(), cuts.cend());
+    }
+
+    // As the upper bound only decreases, these fixings hold in the whole tree.
+    const auto upperBound = m_bestResult.GetBounds().Upper;
+    std::vector<Variable> fixedVariables0;
+    std::vector<Variable> fixedVariables1;
+    AddReducedCostFixings(m_model, lowerBound, upperBound, fixedVariables0, fixedVariables1);
+
+    // then no solution is better than the upper bound
+    if (!rootDomains.Propagate(fixedVariables0, fixedVariables1))
+    {
+        m_bestResult.UpdateLowerBound(upperBound);
+        return;
+    }
+
+    FixVariables(fixedVariables0, 0.0, m_model);
+    FixVariables(fixedVariables1, 1.0, m_model);
+    FixImpliedVariables(rootDomains, X, fixedVariables0, fixedVariables1, m_model);
+
+    const auto binaryVariables = m_model.GetBinaryVariables();
+    const auto numberOfFixedVariables = std::count_if(
+        binaryVariables.begin(), binaryVariables.end(),
+        [&](Variable v) { return v.GetLowerBound(m_model) == v.GetUpperBound(m_model); });
+
+    if (static_cast<double>(numberOfFixedVariables)
+        >= CompactionThreshold * static_cast<double>(binaryVariables.size()))
+    {
+        m_model.Compact();
+    }
+}
+
 std::vector<std::vector<size_t>> tsplp::MtspModel::CreatePathsFromVariables(
     const Model& model) const
 {
@@ -530,12 +1059,17 @@ std::vector<std::vector<size_t>> tsplp::MtspModel::CreatePathsFromVariables(
     {
         paths[a].push_back(m_weightManager.StartPositions()[a]);
 
+        // edges have no direction, so the path must not go back, starting with the artificial edge
+        auto previous = m_weightManager.EndPositions()[a];
+
         for (size_t i = 1; i < N; ++i)
         {
             for (size_t n = 0; n < N; ++n)
             {
-                if (X(a, paths[a].back(), n).GetObjectiveValue(model) > 1 - 1.e-10)
+                if ((!m_isUndirected || n != previous)
+                    && X(a, paths[a].back(), n).GetObjectiveValue(model) > 1 - 1.e-10)
                 {
+                    previous = paths[a].back();
                     paths[a].push_back(n);
                     break;
                 }
@@ -553,6 +1087,10 @@ std::vector<std::vector<size_t>> tsplp::MtspModel::CreatePathsFromVariables(
 std::vector<tsplp::Variable> tsplp::MtspModel::CalculateRecursivelyFixableVariables(
     Variable var) const
 {
+    // the degree constraints only determine the other edges once two of a node are used
+    if (m_isUndirected)
+        return {};
+
     // agent a uses edge (u, v)
     const auto v = var.GetId() % N;
     const auto u = (var.GetId() / N) % N;
@@ -648,44 +1186,787 @@ std::vector<tsplp::Variable> tsplp::MtspModel::CalculateRecursivelyFixableVariab
         }
     }
 
+    std::sort(result.begin(), result.end(), VariableLess {});
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
     return result;
 }
 
-void tsplp::MtspModel::CreateInitialResult()
+void tsplp::MtspModel::CreateInitialResult(size_t threadCount)
 {
-    auto [nearestInsertionPaths, nearestInsertionObjective] = NearestInsertion(
+    // deterministic, and throws if the dependencies are incompatible
+    auto [paths, objective] = NearestInsertion(
         m_optimizationMode, m_weightManager.W(), m_weightManager.StartPositions(),
-        m_weightManager.EndPositions(), m_weightManager.Dependencies(), m_endTime);
+        m_weightManager.EndPositions(), m_weightManager.Dependencies(), m_endTime,
+        &m_weightManager.Neighbors());
 
-    auto [twoOptedPaths, twoOptImprovement] = TwoOptPaths(
-        m_optimizationMode, std::move(nearestInsertionPaths), m_weightManager.W(),
-        m_weightManager.Dependencies(), m_endTime);
+    if (paths.empty())
+        return;
 
-    m_bestResult.UpdateUpperBound(
-        nearestInsertionObjective - twoOptImprovement,
-        m_weightManager.TransformPathsBack(std::move(twoOptedPaths)));
-}
+    auto [improvedPaths, localSearchImprovement] = LocalSearchPaths(
+        m_optimizationMode, std::move(paths), m_weightManager.W(), m_weightManager.Dependencies(),
+        m_weightManager.Neighbors(), m_endTime);
 
-double tsplp::MtspModel::ExploitFractionalSolution(const xt::xtensor<double, 3>& fractionalValues)
-{
-    auto exploitedPaths = tsplp::ExploitFractionalSolution(
-        m_optimizationMode, fractionalValues, m_weightManager.W(), m_weightManager.StartPositions(),
-        m_weightManager.EndPositions(), m_weightManager.Dependencies(), m_endTime);
+    auto bestPaths = std::move(improvedPaths);
+    auto bestObjective = objective - localSearchImprovement;
 
-    if (exploitedPaths.empty())
-        return m_bestResult.GetBounds().Upper;
+    // tiny instances are usually solved exactly anyway, see HeldKarpSolve
+    if (A == 1 && N <= MaxHeldKarpN)
+    {
+        m_initialPaths = bestPaths;
+        m_bestResult.UpdateUpperBound(
+            bestObjective, m_weightManager.TransformPathsBack(std::move(bestPaths)));
+        return;
+    }
 
-    auto [twoOptedPaths, _] = TwoOptPaths(
-        m_optimizationMode, std::move(exploitedPaths), m_weightManager.W(),
-        m_weightManager.Dependencies(), m_endTime);
+    // randomized multi-start on all threads, only the best result is kept
+    constexpr double noise = 0.2;
+    constexpr std::array criteria { InsertionCriterion::Cheapest, InsertionCriterion::Farthest,
+                                    InsertionCriterion::Regret };
 
-    const auto exploitedObjective
-        = CalculateObjective(m_optimizationMode, twoOptedPaths, m_weightManager.W());
+    threadCount = std::max(threadCount, size_t { 1 });
+    const auto hasSavings = A > 1 && m_weightManager.Dependencies().GetArcs().empty();
+    const auto numberOfMethods = criteria.size() + (hasSavings ? 1 : 0);
+    const auto numberOfStarts = std::max(threadCount, numberOfMethods);
 
-    return m_bestResult
-        .UpdateUpperBound(
-            exploitedObjective, m_weightManager.TransformPathsBack(std::move(twoOptedPaths)))
-        .Upper;
+    std::mutex mutex;
+    size_t nextStart = 0;
+
+    const auto threadLoop = [&]
+    {
+        while (std::chrono::steady_clock::now() < m_endTime)
+        {
+            size_t start = 0;
+            {
+                std::unique_lock lock { mutex };
+                if (nextStart == numberOfStarts)
+                    break;
+                start = nextStart++;
+            }
+
+            const auto method = start % numberOfMethods;
+            auto [startPaths, startObjective] = method < criteria.size()
+                ? RandomizedInsertion(
+                    m_optimizationMode, m_weightManager.W(), m_weightManager.StartPositions(),
+                    m_weightManager.EndPositions(), m_weightManager.Dependencies(),
+                    criteria[method], start, noise, m_endTime)
+                : SavingsPaths(
+                    m_optimizationMode, m_weightManager.W(), m_weightManager.StartPositions(),
+                    m_weightManager.EndPositions(), m_weightManager.Neighbors(), start, noise,
+                    m_endTime);
+
+            if (startPaths.empty())
+                continue;
+
+            auto [improvedStartPaths, startImprovement] = LocalSearchPaths(
+                m_optimizationMode, std::move(startPaths), m_weightManager.W(),
+                m_weightManager.Dependencies(), m_weightManager.Neighbors(), m_endTime);
+
+            std::unique_lock lock { mutex };
+            if (startObjective - startImprovement < bestObjective)
+            {
+                bestPaths = std::move(improvedStartPaths);
+                bestObjective = startObjective - startImprovement;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < threadCount; ++t)
+        threads.emplace_back(threadLoop);
+
+    threadLoop();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    m_initialPaths = bestPaths;
+    m_bestResult.UpdateUpperBound(
+        bestObjective, m_weightManager.TransformPathsBack(std::move(bestPaths)));
+}
+
+void tsplp::MtspModel::HeuristicSolve(std::optional<size_t> noOfThreads)
+{
+    const auto threadCount
+        = noOfThreads && *noOfThreads > 0 ? *noOfThreads : std::thread::hardware_concurrency();
+
+    if (m_optimizationMode != OptimizationMode::Sum && m_optimizationMode != OptimizationMode::Max)
+        return;
+
+    m_bestResult.UpdateLowerBound(CalculateDegreeLowerBound(m_weightManager, m_optimizationMode));
+
+    if (std::chrono::steady_clock::now() >= m_endTime)
+    {
+        m_bestResult.SetTimeoutHit();
+        return;
+    }
+
+    // no initial result means infeasible, see NearestInsertion
+    if (m_initialPaths.empty())
+        return;
+
+    if (A == 1 && N <= MaxHeldKarpN)
+    {
+        HeldKarpSolve();
+        return;
+    }
+
+    // ruin and recreate moves groups of nodes between paths, where perturbations of single nodes
+    // rarely lead to improvements
+    if (A > 1)
+    {
+        auto [paths, objective] = LargeNeighborhoodSearch(
+            m_optimizationMode, m_initialPaths, m_weightManager.W(),
+            m_weightManager.Dependencies(), m_weightManager.Neighbors(), m_endTime, threadCount,
+            m_bestResult.GetBounds().Lower);
+
+        m_bestResult.UpdateUpperBound(
+            objective, m_weightManager.TransformPathsBack(std::move(paths)));
+    }
+    else
+    {
+        IteratedLocalSearch(threadCount);
+    }
+
+    const auto bounds = m_bestResult.GetBounds();
+    if (bounds.Lower < bounds.Upper && std::chrono::steady_clock::now() >= m_endTime)
+        m_bestResult.SetTimeoutHit();
+}
+
+void tsplp::MtspModel::HeldKarpSolve()
+{
+    const auto start = m_weightManager.StartPositions()[0];
+    const auto end = m_weightManager.EndPositions()[0];
+
+    auto [path, length] = HeldKarpPath(
+        m_weightManager.W(), start, end, m_weightManager.Dependencies());
+
+    if (path.empty())
+    {
+        m_bestResult.UpdateLowerBound(std::numeric_limits<double>::max());
+        return;
+    }
+
+    std::vector<std::vector<size_t>> paths { std::move(path) };
+    m_bestResult.UpdateUpperBound(length, m_weightManager.TransformPathsBack(std::move(paths)));
+    m_bestResult.UpdateLowerBound(length);
+}
+
+void tsplp::MtspModel::IteratedLocalSearch(size_t threadCount)
+{
+    const auto movableNodes = FindMovableNodes(m_weightManager);
+
+    // the initial result is a local optimum already, without perturbations there is nothing to do
+    if (movableNodes.empty())
+        return;
+
+    std::mutex incumbentMutex;
+    auto incumbentPaths = m_initialPaths;
+    auto incumbentObjective
+        = CalculateObjective(m_optimizationMode, incumbentPaths, m_weightManager.W());
+
+    const auto threadLoop = [&](const size_t threadId)
+    {
+        std::mt19937_64 generator(threadId);
+
+        std::vector<std::vector<size_t>> paths;
+        auto objective = std::numeric_limits<double>::max();
+
+        while (std::chrono::steady_clock::now() < m_endTime)
+        {
+            const auto bounds = m_bestResult.GetBounds();
+            if (bounds.Lower >= bounds.Upper)
+                break;
+
+            // continue from the best paths of all threads
+            {
+                std::unique_lock lock { incumbentMutex };
+                if (incumbentObjective < objective)
+                {
+                    paths = incumbentPaths;
+                    objective = incumbentObjective;
+                }
+            }
+
+            auto [improvedPaths, _] = LocalSearchPaths(
+                m_optimizationMode, PerturbPaths(paths, movableNodes, generator),
+                m_weightManager.W(), m_weightManager.Dependencies(), m_weightManager.Neighbors(),
+                m_endTime);
+
+            const auto improvedObjective
+                = CalculateObjective(m_optimizationMode, improvedPaths, m_weightManager.W());
+            if (improvedObjective >= objective)
+                continue;
+
+            paths = std::move(improvedPaths);
+            objective = improvedObjective;
+
+            std::unique_lock lock { incumbentMutex };
+            if (objective < incumbentObjective)
+            {
+                incumbentPaths = paths;
+                incumbentObjective = objective;
+                m_bestResult.UpdateUpperBound(
+                    objective, m_weightManager.TransformPathsBack(paths));
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < threadCount; ++t)
+        threads.emplace_back(threadLoop, t);
+
+    threadLoop(0);
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void tsplp::MtspModel::DecompositionSolve(std::optional<size_t> noOfThreads)
+{
+    const auto threadCount
+        = noOfThreads && *noOfThreads > 0 ? *noOfThreads : std::thread::hardware_concurrency();
+
+    if (m_optimizationMode != OptimizationMode::Sum && m_optimizationMode != OptimizationMode::Max)
+        return;
+
+    m_bestResult.UpdateLowerBound(CalculateDegreeLowerBound(m_weightManager, m_optimizationMode));
+
+    if (std::chrono::steady_clock::now() >= m_endTime)
+    {
+        m_bestResult.SetTimeoutHit();
+        return;
+    }
+
+    // no initial result means infeasible, see NearestInsertion
+    if (m_initialPaths.empty())
+        return;
+
+    const auto& startPositions = m_weightManager.StartPositions();
+    const auto& endPositions = m_weightManager.EndPositions();
+
+    auto clusters = BalancedClusters(
+        m_weightManager.W(), startPositions, endPositions, m_weightManager.Dependencies());
+
+    // Starts from the initial result, so there are always feasible paths to fall back to. The
+    // nodes of the cluster each path was routed for are kept sorted, to detect changed clusters.
+    auto paths = m_initialPaths;
+    auto isInitial = true;
+    std::vector<std::vector<size_t>> routedClusters(A);
+
+    while (std::chrono::steady_clock::now() < m_endTime)
+    {
+        const auto bounds = m_bestResult.GetBounds();
+        if (bounds.Lower >= bounds.Upper)
+            break;
+
+        std::vector<size_t> changedAgents;
+        for (size_t a = 0; a < A; ++a)
+        {
+            std::sort(clusters[a].begin(), clusters[a].end());
+            if (isInitial || clusters[a] != routedClusters[a])
+                changedAgents.push_back(a);
+        }
+
+        if (changedAgents.empty())
+            break;
+
+        // Every changed cluster is routed by its own MtspModel, in parallel. Half of the remaining
+        // time is shared among them, so that there is time left for further rounds.
+        const auto waves = (changedAgents.size() + threadCount - 1) / threadCount;
+        const auto routingTime = (m_endTime - std::chrono::steady_clock::now())
+            / static_cast<std::chrono::steady_clock::rep>(2 * waves);
+
+        // the paths only replace the previous ones together, as a single missing one would leave
+        // its nodes unvisited or visited twice
+        auto routedPaths = paths;
+        bool isRouted = true;
+
+        std::mutex mutex;
+        size_t nextAgent = 0;
+
+        const auto threadLoop = [&]
+        {
+            while (true)
+            {
+                size_t a = 0;
+                {
+                    std::unique_lock lock { mutex };
+                    if (nextAgent == changedAgents.size())
+                        break;
+                    a = changedAgents[nextAgent++];
+                }
+
+                std::vector<size_t> nodes { startPositions[a] };
+                nodes.insert(nodes.end(), clusters[a].begin(), clusters[a].end());
+                nodes.push_back(endPositions[a]);
+
+                // the sub-model may time out without any result, e.g. if its timeout rounds down
+                // to 0 ms
+                auto path = SolveSinglePath(
+                    nodes, m_weightManager.W(),
+                    std::min(std::chrono::steady_clock::now() + routingTime, m_endTime),
+                    m_name + " Cluster " + std::to_string(a));
+                if (path.empty())
+                {
+                    std::unique_lock lock { mutex };
+                    isRouted = false;
+                    continue;
+                }
+
+                routedPaths[a] = std::move(path);
+                routedClusters[a] = clusters[a];
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < std::min(threadCount, changedAgents.size()); ++t)
+            threads.emplace_back(threadLoop);
+
+        threadLoop();
+
+        for (auto& thread : threads)
+            thread.join();
+
+        if (!isRouted)
+            break;
+
+        paths = std::move(routedPaths);
+        isInitial = false;
+        const auto objective = CalculateObjective(m_optimizationMode, paths, m_weightManager.W());
+        m_bestResult.UpdateUpperBound(objective, m_weightManager.TransformPathsBack(paths));
+
+        // exchange nodes at the boundaries of the clusters, and improve the paths whose sub-model
+        // timed out before proving optimality
+        auto [exchangedPaths, improvement] = LocalSearchPaths(
+            m_optimizationMode, paths, m_weightManager.W(), m_weightManager.Dependencies(),
+            m_weightManager.Neighbors(), m_endTime);
+
+        if (improvement <= 0.0)
+            break;
+
+        m_bestResult.UpdateUpperBound(
+            objective - improvement, m_weightManager.TransformPathsBack(exchangedPaths));
+
+        paths = std::move(exchangedPaths);
+        for (size_t a = 0; a < A; ++a)
+            clusters[a].assign(paths[a].begin() + 1, paths[a].end() - 1);
+    }
+
+    // Large clusters may not have been routed optimally in their share of the time, so the rest
+    // of it polishes the paths window by window.
+    if (const auto bounds = m_bestResult.GetBounds();
+        bounds.Lower < bounds.Upper && std::chrono::steady_clock::now() < m_endTime)
+    {
+        auto [polishedPaths, polishedObjective] = OptimizeWindows(
+            m_optimizationMode, paths, m_weightManager.W(), m_endTime, DefaultWindowSize,
+            threadCount);
+        m_bestResult.UpdateUpperBound(
+            polishedObjective, m_weightManager.TransformPathsBack(std::move(polishedPaths)));
+    }
+
+    const auto bounds = m_bestResult.GetBounds();
+    if (bounds.Lower < bounds.Upper && std::chrono::steady_clock::now() >= m_endTime)
+        m_bestResult.SetTimeoutHit();
+}
+
+void tsplp::MtspModel::BoundSolve(
+    std::optional<size_t> noOfThreads,
+    std::function<void(const xt::xtensor<double, 3>&)> fractionalCallback)
+{
+    const auto threadCount
+        = noOfThreads && *noOfThreads > 0 ? *noOfThreads : std::thread::hardware_concurrency();
+
+    CreateLinearProgram();
+
+    if (std::chrono::steady_clock::now() >= m_endTime)
+    {
+        m_bestResult.SetTimeoutHit();
+        return;
+    }
+
+    // each thread needs its own separator, their support graphs must not be shared
+    std::vector<std::unique_ptr<graph::Separator>> separators;
+    for (size_t t = 0; t < std::min(threadCount, NumberOfSeparationAlgorithms); ++t)
+        separators.push_back(
+            std::make_unique<graph::Separator>(X, m_weightManager, m_model, m_isUndirected));
+
+    std::vector<double> objectives;
+    std::optional<xt::xtensor<double, 3>> fractionalValues;
+
+    while (true)
+    {
+        const auto solutionStatus = m_model.Solve(m_endTime);
+        if (solutionStatus == Status::Timeout)
+        {
+            m_bestResult.SetTimeoutHit();
+            break;
+        }
+
+        // without fixed variables, this means the problem is infeasible
+        if (solutionStatus == Status::Infeasible)
+        {
+            m_bestResult.UpdateLowerBound(std::numeric_limits<double>::max());
+            return;
+        }
+
+        if (solutionStatus != Status::Optimal)
+            throw std::logic_error(m_name + ": Unexpected error happened while solving LP.");
+
+        const auto objective = m_objective.Objective.Evaluate(m_model);
+        const auto [lowerBound, upperBound]
+            = m_bestResult.UpdateLowerBound(std::ceil(objective - 1.e-10));
+
+        if (fractionalCallback != nullptr)
+        {
+            fractionalValues
+                = xt::vectorize([&](Variable v) { return v.GetObjectiveValue(m_model); })(X);
+        }
+
+        if (lowerBound >= upperBound)
+            break;
+
+        objectives.push_back(objective);
+        if (objectives.size() > TailOffRounds
+            && objective - objectives[objectives.size() - 1 - TailOffRounds]
+                <= TailOffImprovement * std::abs(objective))
+        {
+            break;
+        }
+
+        if (std::chrono::steady_clock::now() >= m_endTime)
+        {
+            m_bestResult.SetTimeoutHit();
+            break;
+        }
+
+        std::vector<std::vector<LinearConstraint>> cuts(NumberOfSeparationAlgorithms);
+        const auto threadLoop = [&](const size_t threadId)
+        {
+            for (auto algorithm = threadId; algorithm < cuts.size(); algorithm += separators.size())
+                cuts[algorithm] = Separate(*separators[threadId], algorithm);
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < separators.size(); ++t)
+            threads.emplace_back(threadLoop, t);
+
+        threadLoop(0);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        std::vector<LinearConstraint> constraints;
+        for (auto& algorithmCuts : cuts)
+        {
+            constraints.insert(
+                constraints.end(), std::make_move_iterator(algorithmCuts.begin()),
+                std::make_move_iterator(algorithmCuts.end()));
+        }
+
+        if (constraints.empty())
+            break;
+
+        m_model.AddConstraints(cbegin(constraints), cend(constraints));
+    }
+
+    if (fractionalCallback != nullptr && fractionalValues.has_value())
+        fractionalCallback(
+            m_weightManager.TransformTensorBack(ArcValues(*fractionalValues, m_isUndirected)));
+}
+
+double tsplp::MtspModel::ExploitFractionalSolution(const xt::xtensor<double, 3>& fractionalValues)
+{
+    auto exploitedPaths = tsplp::ExploitFractionalSolution(
+        m_optimizationMode, fractionalValues, m_weightManager.W(), m_weightManager.StartPositions(),
+        m_weightManager.EndPositions(), m_weightManager.Dependencies(), m_endTime);
+
+    if (exploitedPaths.empty())
+        return m_bestResult.GetBounds().Upper;
+
+    auto [improvedPaths, _] = LocalSearchPaths(
+        m_optimizationMode, std::move(exploitedPaths), m_weightManager.W(),
+        m_weightManager.Dependencies(), m_weightManager.Neighbors(), m_endTime);
+
+    const auto exploitedObjective
+        = CalculateObjective(m_optimizationMode, improvedPaths, m_weightManager.W());
+
+    return m_bestResult
+        .UpdateUpperBound(
+            exploitedObjective, m_weightManager.TransformPathsBack(std::move(improvedPaths)))
+        .Upper;
+}
+
+double tsplp::MtspModel::Dive(Model model, ConstraintDeque& constraints)
+{
+    constexpr size_t maxIterations = 50;
+    constexpr double fixingThreshold = 0.9;
+
+    const graph::Separator separator(X, m_weightManager, model, m_isUndirected);
+
+    for (size_t iteration = 0; iteration < maxIterations; ++iteration)
+    {
+        if (std::chrono::steady_clock::now() >= m_endTime)
+            break;
+
+        std::vector<LinearConstraint> cuts;
+        for (size_t algorithm = 0; algorithm < NumberOfSeparationAlgorithms && cuts.empty();
+             ++algorithm)
+        {
+            cuts = Separate(separator, algorithm);
+        }
+
+        if (!cuts.empty())
+        {
+            // the cuts don't depend on the fixings, so the other threads can use them as well
+            model.AddConstraints(cuts.cbegin(), cuts.cend());
+            constraints.Push(cuts.cbegin(), cuts.cend());
+        }
+        else
+        {
+            if (!FindFractionalVariable(model).has_value())
+            {
+                const auto objective = std::ceil(m_objective.Objective.Evaluate(model) - 1.e-10);
+                if (objective < m_bestResult.GetBounds().Upper)
+                    m_bestResult.UpdateUpperBound(objective, CreatePathsFromVariables(model));
+                break;
+            }
+
+            // fix the arcs that are nearly 1, and at least the most integral fractional one
+            std::vector<Variable> candidates;
+            for (const auto v : model.GetBinaryVariables())
+            {
+                if (v.GetLowerBound(model) == 0.0 && v.GetUpperBound(model) == 1.0
+                    && v.GetObjectiveValue(model) > 1.e-10)
+                {
+                    candidates.push_back(v);
+                }
+            }
+            std::sort(
+                candidates.begin(), candidates.end(), [&](Variable v, Variable w)
+                { return v.GetObjectiveValue(model) > w.GetObjectiveValue(model); });
+
+            bool isFractionalFixed = false;
+            for (const auto v : candidates)
+            {
+                const auto value = v.GetObjectiveValue(model);
+                if (value < fixingThreshold && isFractionalFixed)
+                    break;
+
+                // may have been fixed to 0 by one of the previous candidates
+                if (v.GetUpperBound(model) == 0.0)
+                    continue;
+
+                isFractionalFixed = isFractionalFixed || value < 1.0 - 1.e-10;
+                v.Fix(1.0, model);
+                for (const auto w : CalculateRecursivelyFixableVariables(v))
+                {
+                    if (w.GetLowerBound(model) == 0.0)
+                        w.Fix(0.0, model);
+                }
+            }
+        }
+
+        // the solver starts from the previous basis
+        if (model.Solve(m_endTime) != Status::Optimal)
+            break;
+
+        const auto lowerBound = std::ceil(m_objective.Objective.Evaluate(model) - 1.e-10);
+        if (lowerBound >= m_bestResult.GetBounds().Upper)
+            break;
+    }
+
+    return m_bestResult.GetBounds().Upper;
+}
+
+void tsplp::MtspModel::RunPrimalHeuristic(SolutionMailbox& mailbox, ConstraintDeque& constraints)
+{
+    std::mt19937_64 generator(0);
+    const auto movableNodes = FindMovableNodes(m_weightManager);
+
+    auto incumbentPaths = m_initialPaths;
+    auto incumbentObjective = incumbentPaths.empty()
+        ? std::numeric_limits<double>::max()
+        : CalculateObjective(m_optimizationMode, incumbentPaths, m_weightManager.W());
+
+    // local search, and the result replaces the incumbent if it is better
+    const auto improve = [&](std::vector<std::vector<size_t>> paths)
+    {
+        if (paths.empty())
+            return paths;
+
+        auto [improvedPaths, _] = LocalSearchPaths(
+            m_optimizationMode, std::move(paths), m_weightManager.W(),
+            m_weightManager.Dependencies(), m_weightManager.Neighbors(), m_endTime);
+
+        const auto objective
+            = CalculateObjective(m_optimizationMode, improvedPaths, m_weightManager.W());
+        if (objective < incumbentObjective)
+        {
+            incumbentPaths = improvedPaths;
+            incumbentObjective = objective;
+            m_bestResult.UpdateUpperBound(
+                objective, m_weightManager.TransformPathsBack(improvedPaths));
+        }
+
+        return improvedPaths;
+    };
+
+    while (!mailbox.IsClosed() && std::chrono::steady_clock::now() < m_endTime)
+    {
+        const auto bounds = m_bestResult.GetBounds();
+        if (bounds.Lower >= bounds.Upper)
+            break;
+
+        // the workers improve the result as well, so the incumbent may be outdated
+        if (bounds.Upper < incumbentObjective)
+        {
+            auto bestPaths = m_weightManager.TransformPaths(m_bestResult.CopyPaths());
+            if (!bestPaths.empty())
+            {
+                incumbentObjective
+                    = CalculateObjective(m_optimizationMode, bestPaths, m_weightManager.W());
+                incumbentPaths = std::move(bestPaths);
+            }
+        }
+
+        if (auto diveModel = mailbox.TryTakeDive(); diveModel.has_value())
+        {
+            Dive(std::move(*diveModel), constraints);
+            continue;
+        }
+
+        // perturbing the incumbent is the fallback while there is no new fractional solution
+        const auto canPerturb = !incumbentPaths.empty() && !movableNodes.empty();
+        const auto fractionalValues = canPerturb ? mailbox.TryTake() : mailbox.Take(m_endTime);
+
+        if (!fractionalValues.has_value())
+        {
+            if (canPerturb)
+                improve(PerturbPaths(incumbentPaths, movableNodes, generator));
+            continue;
+        }
+
+        const auto previousPaths = incumbentPaths;
+        const auto exploitedPaths = improve(tsplp::ExploitFractionalSolution(
+            m_optimizationMode, *fractionalValues, m_weightManager.W(),
+            m_weightManager.StartPositions(), m_weightManager.EndPositions(),
+            m_weightManager.Dependencies(), m_endTime));
+
+        if (exploitedPaths.empty() || previousPaths.empty() || exploitedPaths == previousPaths)
+            continue;
+
+        // recombine with the previous incumbent: arcs of both paths are free and arcs of one of
+        // them are half price for the insertion
+        auto arcs = xt::xtensor<double, 3>::from_shape({ A, N, N });
+        arcs.fill(0.0);
+        for (const auto* paths : { &previousPaths, &exploitedPaths })
+        {
+            for (size_t a = 0; a < A; ++a)
+            {
+                for (size_t i = 0; i + 1 < (*paths)[a].size(); ++i)
+                    arcs(a, (*paths)[a][i], (*paths)[a][i + 1]) += 0.5;
+            }
+        }
+
+        improve(tsplp::ExploitFractionalSolution(
+            m_optimizationMode, arcs, m_weightManager.W(), m_weightManager.StartPositions(),
+            m_weightManager.EndPositions(), m_weightManager.Dependencies(), m_endTime));
+    }
+}
+
+std::tuple<std::vector<std::vector<size_t>>, double> tsplp::OptimizeWindows(
+    OptimizationMode optimizationMode, std::vector<std::vector<size_t>> paths,
+    const xt::xtensor<double, 2>& weights, std::chrono::steady_clock::time_point endTime,
+    size_t windowSize, size_t numberOfThreads)
+{
+    // smaller windows cannot be improved by more than 2-opt and or-opt moves
+    constexpr size_t minInnerNodes = 3;
+
+    // the optimal order of the nodes of paths[a] from position first to last, or an empty vector
+    // if it is not shorter. Shortening a segment never increases the longest path, so this is
+    // right for both modes.
+    const auto solveWindow = [&](size_t a, size_t first, size_t last)
+    {
+        const std::vector<size_t> nodes(
+            paths[a].begin() + static_cast<std::ptrdiff_t>(first),
+            paths[a].begin() + static_cast<std::ptrdiff_t>(last) + 1);
+
+        auto improvedNodes = SolveSinglePath(nodes, weights, endTime, "Window");
+        if (!improvedNodes.empty()
+            && CalculatePathLength(improvedNodes, weights) >= CalculatePathLength(nodes, weights))
+        {
+            improvedNodes.clear();
+        }
+
+        return improvedNodes;
+    };
+
+    auto isImproved = true;
+    while (isImproved && std::chrono::steady_clock::now() < endTime)
+    {
+        isImproved = false;
+        for (const auto offset : { size_t { 0 }, windowSize / 2 })
+        {
+            // windows of a pass share at most their first or last node, which are fixed
+            std::vector<std::tuple<size_t, size_t, size_t>> windows;
+            for (size_t a = 0; a < paths.size(); ++a)
+            {
+                for (auto first = offset; first + minInnerNodes + 1 < paths[a].size();
+                     first += windowSize + 1)
+                {
+                    const auto last = std::min(first + windowSize + 1, paths[a].size() - 1);
+                    windows.emplace_back(a, first, last);
+                }
+            }
+
+            std::vector<std::vector<size_t>> improvedWindows(windows.size());
+            std::mutex mutex;
+            size_t nextWindow = 0;
+
+            const auto threadLoop = [&]
+            {
+                while (std::chrono::steady_clock::now() < endTime)
+                {
+                    size_t w = 0;
+                    {
+                        std::unique_lock lock { mutex };
+                        if (nextWindow == windows.size())
+                            break;
+                        w = nextWindow++;
+                    }
+
+                    const auto [a, first, last] = windows[w];
+                    improvedWindows[w] = solveWindow(a, first, last);
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (size_t t = 1; t < std::min(numberOfThreads, windows.size()); ++t)
+                threads.emplace_back(threadLoop);
+
+            threadLoop();
+
+            for (auto& thread : threads)
+                thread.join();
+
+            // the windows keep their length, so the positions of the others remain valid
+            for (size_t w = 0; w < windows.size(); ++w)
+            {
+                if (improvedWindows[w].empty())
+                    continue;
+
+                const auto [a, first, last] = windows[w];
+                std::copy(
+                    improvedWindows[w].begin(), improvedWindows[w].end(),
+                    paths[a].begin() + static_cast<std::ptrdiff_t>(first));
+                isImproved = true;
+            }
+        }
+    }
+
+    const auto objective = CalculateObjective(optimizationMode, paths, weights);
+    return { std::move(paths), objective };
 }
 
 tsplp::LinearObjective tsplp::CreateObjective(
@@ -17,6 +17,12 @@ bool MtspResult::IsTimeoutHit() const
     return m_isTimeoutHit;
 }
 
+std::vector<std::vector<size_t>> MtspResult::CopyPaths() const
+{
+    std::unique_lock lock { m_mutex };
+    return m_paths;
+}
+
 void MtspResult::SetTimeoutHit()
 {
     std::unique_lock lock { m_mutex };
@@ -0,0 +1,238 @@
+#include "NeighborLists.hpp"
+
+#include "KdTree.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <tuple>
+
+namespace tsplp
+{
+namespace
+{
+// below this, spawning threads costs more than it saves
+constexpr size_t minNodesPerThread = 256;
+
+using Candidate = std::tuple<double, double, size_t>;
+
+void StoreNearest(
+    std::vector<Candidate>& candidates, size_t k, size_t n, std::vector<size_t>& neighbors,
+    std::vector<std::pair<size_t, size_t>>& node2SpanMap)
+{
+    const auto numberOfNeighbors = std::min(k, candidates.size());
+    const auto middle = candidates.begin() + static_cast<std::ptrdiff_t>(numberOfNeighbors);
+    std::partial_sort(candidates.begin(), middle, candidates.end());
+
+    // every node owns k slots, so nodes can be processed in parallel
+    const auto rangeBegin = n * k;
+    for (size_t i = 0; i < numberOfNeighbors; ++i)
+        neighbors[rangeBegin + i] = std::get<2>(candidates[i]);
+    node2SpanMap[n] = { rangeBegin, rangeBegin + numberOfNeighbors };
+
+    candidates.clear();
+}
+
+// Calls fillLists for consecutive ranges of nodes on up to numberOfThreads threads.
+template <typename FillLists>
+void RunInParallel(size_t N, size_t numberOfThreads, const FillLists& fillLists)
+{
+    numberOfThreads
+        = std::max(std::min(numberOfThreads, N / minNodesPerThread), static_cast<size_t>(1));
+    const auto nodesPerThread = (N + numberOfThreads - 1) / numberOfThreads;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numberOfThreads; ++t)
+        threads.emplace_back(fillLists, t * nodesPerThread, std::min(N, (t + 1) * nodesPerThread));
+
+    fillLists(0, std::min(N, nodesPerThread));
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+double SymmetricWeight(const xt::xtensor<double, 2>& weights, size_t u, size_t v)
+{
+    // at most one direction is a reverse arc of a dependency
+    const auto uv = weights(u, v);
+    const auto vu = weights(v, u);
+    if (uv < 0)
+        return vu;
+    if (vu < 0)
+        return uv;
+    return std::min(uv, vu);
+}
+
+class MinimumSpanningTree
+{
+private:
+    const xt::xtensor<double, 2>& m_weights;
+
+    // nodes in the order they were added to the tree, so parents precede their children
+    std::vector<size_t> m_order;
+    std::vector<size_t> m_parents;
+    std::vector<double> m_parentWeights;
+
+public:
+    // Prim's algorithm in O(N^2), which is optimal for dense weights.
+    explicit MinimumSpanningTree(const xt::xtensor<double, 2>& weights)
+        : m_weights(weights)
+        , m_parents(weights.shape(0), weights.shape(0))
+        , m_parentWeights(weights.shape(0), std::numeric_limits<double>::max())
+    {
+        const auto N = weights.shape(0);
+        m_order.reserve(N);
+
+        std::vector<bool> isInTree(N, false);
+        auto next = static_cast<size_t>(0);
+        for (size_t i = 0; i < N; ++i)
+        {
+            const auto u = next;
+            isInTree[u] = true;
+            m_order.push_back(u);
+
+            next = N;
+            for (size_t v = 0; v < N; ++v)
+            {
+                if (isInTree[v])
+                    continue;
+
+                if (const auto w = SymmetricWeight(weights, u, v); w < m_parentWeights[v])
+                {
+                    m_parentWeights[v] = w;
+                    m_parents[v] = u;
+                }
+
+                if (next == N || m_parentWeights[v] < m_parentWeights[next])
+                    next = v;
+            }
+        }
+    }
+
+    // alpha(u, v) is the weight of (u, v) minus the largest weight on the tree path from u to v
+    // (Helsgaun), O(N) for all v. beta and marks are scratch space of size N.
+    void CalculateAlphaNearness(
+        size_t u, std::vector<double>& alphas, std::vector<double>& beta,
+        std::vector<size_t>& marks) const
+    {
+        const auto N = m_parents.size();
+
+        beta[u] = std::numeric_limits<double>::lowest();
+        marks[u] = u;
+        for (auto k = u; m_parents[k] != N; k = m_parents[k])
+        {
+            beta[m_parents[k]] = std::max(beta[k], m_parentWeights[k]);
+            marks[m_parents[k]] = u;
+        }
+
+        for (const auto v : m_order)
+        {
+            if (v == u)
+                continue;
+
+            if (marks[v] != u)
+                beta[v] = std::max(beta[m_parents[v]], m_parentWeights[v]);
+
+            alphas[v] = SymmetricWeight(m_weights, u, v) - beta[v];
+        }
+    }
+};
+}
+
+NeighborLists::NeighborLists(
+    const xt::xtensor<double, 2>& weights, size_t k, Measure measure, size_t numberOfThreads)
+{
+    const auto N = weights.shape(0);
+    k = std::min(k, N);
+
+    m_outgoing.resize(N * k);
+    m_incoming.resize(N * k);
+    m_node2outgoingSpanMap.resize(N);
+    m_node2incomingSpanMap.resize(N);
+
+    const auto spTree = measure == Measure::AlphaNearness
+        ? std::make_unique<MinimumSpanningTree>(weights)
+        : nullptr;
+
+    const auto fillLists = [&](size_t firstNode, size_t lastNode)
+    {
+        std::vector<Candidate> candidates;
+        candidates.reserve(N);
+
+        std::vector<double> alphas(spTree ? N : 0);
+        std::vector<double> beta(spTree ? N : 0);
+        std::vector<size_t> marks(spTree ? N : 0, N);
+
+        for (auto u = firstNode; u < lastNode; ++u)
+        {
+            if (spTree)
+                spTree->CalculateAlphaNearness(u, alphas, beta, marks);
+
+            for (size_t v = 0; v < N; ++v)
+            {
+                if (u != v && weights(u, v) >= 0)
+                    candidates.emplace_back(spTree ? alphas[v] : weights(u, v), weights(u, v), v);
+            }
+
+            StoreNearest(candidates, k, u, m_outgoing, m_node2outgoingSpanMap);
+
+            // alpha-nearness is symmetric, so the same values serve for the incoming arcs
+            for (size_t v = 0; v < N; ++v)
+            {
+                if (u != v && weights(v, u) >= 0)
+                    candidates.emplace_back(spTree ? alphas[v] : weights(v, u), weights(v, u), v);
+            }
+
+            StoreNearest(candidates, k, u, m_incoming, m_node2incomingSpanMap);
+        }
+    };
+
+    RunInParallel(N, numberOfThreads, fillLists);
+}
+
+NeighborLists::NeighborLists(CoordinateWeights weights, size_t k, size_t numberOfThreads)
+{
+    const auto N = weights.N();
+    k = std::min(k, N);
+
+    m_outgoing.resize(N * k);
+    m_node2outgoingSpanMap.resize(N);
+
+    const KdTree tree(weights);
+
+    // sorted by weight again, since the order of the k-d tree ignores the rounding of the weights
+    const auto fillLists = [&](size_t firstNode, size_t lastNode)
+    {
+        std::vector<Candidate> candidates;
+        candidates.reserve(k);
+
+        for (auto u = firstNode; u < lastNode; ++u)
+        {
+            for (const auto v : tree.FindNearest(u, k))
+                candidates.emplace_back(weights(u, v), weights(u, v), v);
+
+            StoreNearest(candidates, k, u, m_outgoing, m_node2outgoingSpanMap);
+        }
+    };
+
+    RunInParallel(N, numberOfThreads, fillLists);
+
+    m_incoming = m_outgoing;
+    m_node2incomingSpanMap = m_node2outgoingSpanMap;
+}
+
+std::span<const size_t> NeighborLists::GetOutgoingSpan(size_t n) const
+{
+    const auto [s, t] = m_node2outgoingSpanMap[n];
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return { m_outgoing.data() + s, m_outgoing.data() + t };
+}
+
+std::span<const size_t> NeighborLists::GetIncomingSpan(size_t n) const
+{
+    const auto [s, t] = m_node2incomingSpanMap[n];
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return { m_incoming.data() + s, m_incoming.data() + t };
+}
+}
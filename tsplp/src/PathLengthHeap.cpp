@@ -0,0 +1,84 @@
+#include "PathLengthHeap.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace tsplp
+{
+PathLengthHeap::PathLengthHeap(std::vector<double> lengths)
+    : m_lengths(std::move(lengths))
+    , m_heap(m_lengths.size())
+    , m_path2HeapPosition(m_lengths.size())
+{
+    std::iota(m_heap.begin(), m_heap.end(), 0);
+    std::iota(m_path2HeapPosition.begin(), m_path2HeapPosition.end(), 0);
+
+    for (auto h = m_heap.size() / 2; h > 0; --h)
+        SiftDown(h - 1);
+}
+
+double PathLengthHeap::GetLongestLengthExcluding(size_t a1, size_t a2) const
+{
+    // All ancestors of the longest remaining path are excluded, so with two excluded paths, it is
+    // found within the first three levels of the heap.
+    double length = 0.0;
+    for (size_t h = 0; h < std::min(m_heap.size(), static_cast<size_t>(7)); ++h)
+    {
+        const auto a = m_heap[h];
+        if (a != a1 && a != a2)
+            length = std::max(length, m_lengths[a]);
+    }
+
+    return length;
+}
+
+void PathLengthHeap::Update(size_t a, double length)
+{
+    const auto oldLength = m_lengths[a];
+    m_lengths[a] = length;
+
+    if (length > oldLength)
+        SiftUp(m_path2HeapPosition[a]);
+    else
+        SiftDown(m_path2HeapPosition[a]);
+}
+
+void PathLengthHeap::SiftUp(size_t h)
+{
+    while (h > 0)
+    {
+        const auto parent = (h - 1) / 2;
+        if (m_lengths[m_heap[parent]] >= m_lengths[m_heap[h]])
+            return;
+
+        Swap(h, parent);
+        h = parent;
+    }
+}
+
+void PathLengthHeap::SiftDown(size_t h)
+{
+    while (true)
+    {
+        auto largest = h;
+        for (const auto child : { 2 * h + 1, 2 * h + 2 })
+        {
+            if (child < m_heap.size() && m_lengths[m_heap[child]] > m_lengths[m_heap[largest]])
+                largest = child;
+        }
+
+        if (largest == h)
+            return;
+
+        Swap(h, largest);
+        h = largest;
+    }
+}
+
+void PathLengthHeap::Swap(size_t h1, size_t h2)
+{
+    std::swap(m_heap[h1], m_heap[h2]);
+    m_path2HeapPosition[m_heap[h1]] = h1;
+    m_path2HeapPosition[m_heap[h2]] = h2;
+}
+}
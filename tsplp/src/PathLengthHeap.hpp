@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace tsplp
+{
+// Max-heap of path lengths that supports changing the length of an arbitrary path. Apart from the
+// longest path, also the longest path besides two given paths is available in O(1).
+class PathLengthHeap
+{
+private:
+    std::vector<double> m_lengths;
+    std::vector<size_t> m_heap;
+    std::vector<size_t> m_path2HeapPosition;
+
+public:
+    explicit PathLengthHeap(std::vector<double> lengths);
+
+    [[nodiscard]] double GetLength(size_t a) const { return m_lengths[a]; }
+
+    // Only valid if there is at least one path.
+    [[nodiscard]] size_t GetLongestPath() const { return m_heap.front(); }
+    [[nodiscard]] double GetLongestLength() const { return m_lengths[m_heap.front()]; }
+
+    // Returns 0 if there are no other paths.
+    [[nodiscard]] double GetLongestLengthExcluding(size_t a1, size_t a2) const;
+
+    void Update(size_t a, double length);
+
+private:
+    void SiftUp(size_t h);
+    void SiftDown(size_t h);
+    void Swap(size_t h1, size_t h2);
+};
+}
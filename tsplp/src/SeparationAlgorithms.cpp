@@ -15,7 +15,6 @@
 #include <boost/graph/stoer_wagner_min_cut.hpp>
 #include <boost/range/iterator_range.hpp>
 #include <xtensor/xtensor.hpp>
-#include <xtensor/xvectorize.hpp>
 #include <xtensor/xview.hpp>
 
 namespace tsplp::graph
@@ -26,10 +25,11 @@ using UndirectedGraph = boost::adjacency_list<
 
 Separator::Separator(
     const xt::xtensor<Variable, 3>& variables, const WeightManager& weightManager,
-    const Model& model)
+    const Model& model, bool isUndirected)
     : m_variables(variables)
     , m_weightManager(weightManager)
     , m_model(model)
+    , m_isUndirected(isUndirected)
     , m_spSupportGraph( // TODO: create only on demand
           std::make_unique<PiSigmaSupportGraph>(variables, weightManager.Dependencies(), model))
 {
@@ -37,23 +37,39 @@ Separator::Separator(
 
 Separator::~Separator() noexcept = default;
 
+double Separator::EdgeValue(size_t u, size_t v) const
+{
+    double value = 0;
+    for (size_t a = 0; a < m_variables.shape(0); ++a)
+    {
+        value += m_variables(a, u, v).GetObjectiveValue(m_model);
+        if (!m_isUndirected)
+            value += m_variables(a, v, u).GetObjectiveValue(m_model);
+    }
+    return value;
+}
+
+LinearVariableComposition Separator::EdgeVariables(size_t u, size_t v) const
+{
+    LinearVariableComposition edge;
+    for (size_t a = 0; a < m_variables.shape(0); ++a)
+    {
+        edge += m_variables(a, u, v);
+        if (!m_isUndirected)
+            edge += m_variables(a, v, u);
+    }
+    return edge;
+}
+
 std::optional<LinearConstraint> Separator::Ucut() const
 {
-    const auto A = m_weightManager.A();
     const auto N = m_weightManager.N();
-    const auto vf = xt::vectorize([this](Variable v) { return v.GetObjectiveValue(m_model); });
-    const auto values = vf(m_variables);
 
     UndirectedGraph graph(N);
     for (size_t u = 0; u < N; ++u)
     {
         for (size_t v = u + 1; v < N; ++v)
-        {
-            double weight = 0;
-            for (size_t a = 0; a < A; ++a)
-                weight += values(a, u, v) + values(a, v, u);
-            boost::add_edge(u, v, weight, graph);
-        }
+            boost::add_edge(u, v, EdgeValue(u, v), graph);
     }
 
     const auto parities = boost::make_one_bit_color_map(N, get(boost::vertex_index, graph));
@@ -67,13 +83,10 @@ std::optional<LinearConstraint> Separator::Ucut() const
     LinearVariableComposition sum;
     for (size_t u = 0; u < N; ++u)
     {
-        for (size_t v = 0; v < N; ++v)
+        for (size_t v = u + 1; v < N; ++v)
         {
             if (get(parities, u) != get(parities, v))
-            {
-                for (size_t a = 0; a < A; ++a)
-                    sum += m_variables(a, u, v);
-            }
+                sum += EdgeVariables(u, v);
         }
     }
 
@@ -198,10 +211,7 @@ std::optional<LinearConstraint> Separator::PiSigma() const
 
 std::vector<LinearConstraint> Separator::TwoMatching() const
 {
-    const auto A = m_weightManager.A();
     const auto N = m_weightManager.N();
-    const auto vf = xt::vectorize([this](Variable v) { return v.GetObjectiveValue(m_model); });
-    const auto values = vf(m_variables);
 
     std::vector<double> edge2WeightMap(N * (N - 1) / 2);
     std::vector<double> edge2CapacityMap(N * (N - 1) / 2);
@@ -209,10 +219,7 @@ std::vector<LinearConstraint> Separator::TwoMatching() const
     {
         for (size_t v = 0; v < u; ++v)
         {
-            double weight = 0;
-            for (size_t a = 0; a < A; ++a)
-                weight += values(a, u, v) + values(a, v, u);
-            weight = std::max(0.0, std::min(1.0, weight));
+            const auto weight = std::max(0.0, std::min(1.0, EdgeValue(u, v)));
 
             const auto capacity = std::min(weight, 1 - weight);
             edge2CapacityMap[u * (u - 1) / 2 + v] = capacity;
@@ -266,12 +273,7 @@ std::vector<LinearConstraint> Separator::TwoMatching() const
                 ForAllCutEdges(
                     [&](size_t u, size_t v)
                     {
-                        LinearVariableComposition constraintPart;
-                        for (size_t a = 0; a < A; ++a)
-                        {
-                            constraintPart += m_variables(a, u, v);
-                            constraintPart += m_variables(a, v, u);
-                        }
+                        auto constraintPart = EdgeVariables(u, v);
                         if (edge2WeightMap[u * (u - 1) / 2 + v] > 0.5)
                         {
                             rhs += std::move(constraintPart) - 1;
@@ -313,12 +315,7 @@ std::vector<LinearConstraint> Separator::TwoMatching() const
                     ForAllCutEdges(
                         [&](size_t u, size_t v)
                         {
-                            LinearVariableComposition constraintPart;
-                            for (size_t a = 0; a < A; ++a)
-                            {
-                                constraintPart += m_variables(a, u, v);
-                                constraintPart += m_variables(a, v, u);
-                            }
+                            auto constraintPart = EdgeVariables(u, v);
 
                             const auto weight = edge2WeightMap[u * (u - 1) / 2 + v];
                             const auto edge = std::make_pair(u, v);
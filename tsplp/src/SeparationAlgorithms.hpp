@@ -7,6 +7,7 @@
 namespace tsplp
 {
 class LinearConstraint;
+class LinearVariableComposition;
 class Model;
 class Variable;
 class WeightManager;
@@ -22,12 +23,14 @@ private:
     const xt::xtensor<Variable, 3>& m_variables;
     const WeightManager& m_weightManager;
     const Model& m_model;
+    bool m_isUndirected;
     std::unique_ptr<PiSigmaSupportGraph> m_spSupportGraph;
 
 public:
+    // With isUndirected, variables(a, u, v) and variables(a, v, u) are the same edge variable.
     Separator(
         const xt::xtensor<Variable, 3>& variables, const WeightManager& weightManager,
-        const Model& model);
+        const Model& model, bool isUndirected = false);
     ~Separator() noexcept;
 
     Separator(const Separator&) = delete;
@@ -42,5 +45,10 @@ public:
     [[nodiscard]] std::optional<LinearConstraint> PiSigma() const;
 
     [[nodiscard]] std::vector<LinearConstraint> TwoMatching() const;
+
+private:
+    // the usage of the undirected edge {u, v} by all agents, in both directions
+    [[nodiscard]] double EdgeValue(size_t u, size_t v) const;
+    [[nodiscard]] LinearVariableComposition EdgeVariables(size_t u, size_t v) const;
 };
 }
@@ -0,0 +1,62 @@
+#include "SolutionMailbox.hpp"
+
+#include <utility>
+
+void tsplp::SolutionMailbox::Publish(xt::xtensor<double, 3> fractionalValues)
+{
+    {
+        std::unique_lock lock { m_mutex };
+        m_fractionalValues = std::move(fractionalValues);
+    }
+
+    m_condition.notify_one();
+}
+
+std::optional<xt::xtensor<double, 3>> tsplp::SolutionMailbox::TryTake()
+{
+    std::unique_lock lock { m_mutex };
+    return std::exchange(m_fractionalValues, std::nullopt);
+}
+
+std::optional<xt::xtensor<double, 3>> tsplp::SolutionMailbox::Take(
+    std::chrono::steady_clock::time_point endTime)
+{
+    std::unique_lock lock { m_mutex };
+    m_condition.wait_until(
+        lock, endTime,
+        [&] { return m_isClosed || m_fractionalValues.has_value() || m_diveModel.has_value(); });
+
+    return std::exchange(m_fractionalValues, std::nullopt);
+}
+
+void tsplp::SolutionMailbox::PublishDive(Model model)
+{
+    {
+        std::unique_lock lock { m_mutex };
+        m_diveModel = std::move(model);
+    }
+
+    m_condition.notify_one();
+}
+
+std::optional<tsplp::Model> tsplp::SolutionMailbox::TryTakeDive()
+{
+    std::unique_lock lock { m_mutex };
+    return std::exchange(m_diveModel, std::nullopt);
+}
+
+void tsplp::SolutionMailbox::Close()
+{
+    {
+        std::unique_lock lock { m_mutex };
+        m_isClosed = true;
+    }
+
+    m_condition.notify_all();
+}
+
+bool tsplp::SolutionMailbox::IsClosed()
+{
+    std::unique_lock lock { m_mutex };
+    return m_isClosed;
+}
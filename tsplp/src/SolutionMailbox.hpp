@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Model.hpp"
+
+#include <xtensor/xtensor.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+
+namespace tsplp
+{
+// Hands the fractional solutions of the branch and cut threads and the models to dive from to the
+// primal heuristic thread. Only the latest of each is kept, so publishing never waits for the
+// heuristic.
+class SolutionMailbox
+{
+private:
+    std::optional<xt::xtensor<double, 3>> m_fractionalValues;
+    std::optional<Model> m_diveModel;
+    bool m_isClosed = false;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+public:
+    void Publish(xt::xtensor<double, 3> fractionalValues);
+
+    // The latest solution, if there is one.
+    [[nodiscard]] std::optional<xt::xtensor<double, 3>> TryTake();
+
+    // Waits for a solution or a model to dive from until the mailbox is closed or endTime is
+    // reached. Returns the solution, if there is one.
+    [[nodiscard]] std::optional<xt::xtensor<double, 3>> Take(
+        std::chrono::steady_clock::time_point endTime);
+
+    void PublishDive(Model model);
+    [[nodiscard]] std::optional<Model> TryTakeDive();
+
+    void Close();
+    [[nodiscard]] bool IsClosed();
+};
+}
@@ -4,6 +4,8 @@
 
 #include <ClpSimplex.hpp>
 
+#include <cassert>
+
 tsplp::Variable::Variable(size_t id)
     : m_id(id)
 {
@@ -11,36 +13,62 @@ tsplp::Variable::Variable(size_t id)
 
 double tsplp::Variable::GetUpperBound(const Model& model) const
 {
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-    return model.m_spSimplexModel->getColUpper()[m_id];
+    if (const auto column = model.m_columns[m_id]; column >= 0)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return model.m_spSimplexModel->getColUpper()[column];
+    }
+
+    return model.m_removedValues[m_id];
 }
 
 double tsplp::Variable::GetLowerBound(const Model& model) const
 {
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-    return model.m_spSimplexModel->getColLower()[m_id];
+    if (const auto column = model.m_columns[m_id]; column >= 0)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return model.m_spSimplexModel->getColLower()[column];
+    }
+
+    return model.m_removedValues[m_id];
 }
 
 void tsplp::Variable::SetUpperBound(double upperBound, Model& model) const
 {
-    model.m_spSimplexModel->setColumnUpper(static_cast<int>(m_id), upperBound);
+    if (const auto column = model.m_columns[m_id]; column >= 0)
+        model.m_spSimplexModel->setColumnUpper(column, upperBound);
+    else
+        assert(upperBound >= model.m_removedValues[m_id]);
 }
 
 void tsplp::Variable::SetLowerBound(double lowerBound, Model& model) const
 {
-    model.m_spSimplexModel->setColumnLower(static_cast<int>(m_id), lowerBound);
+    if (const auto column = model.m_columns[m_id]; column >= 0)
+        model.m_spSimplexModel->setColumnLower(column, lowerBound);
+    else
+        assert(lowerBound <= model.m_removedValues[m_id]);
 }
 
 double tsplp::Variable::GetObjectiveValue(const Model& model) const
 {
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-    return model.m_spSimplexModel->primalColumnSolution()[m_id];
+    if (const auto column = model.m_columns[m_id]; column >= 0)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return model.m_spSimplexModel->primalColumnSolution()[column];
+    }
+
+    return model.m_removedValues[m_id];
 }
 
 double tsplp::Variable::GetReducedCosts(const Model& model) const
 {
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-    return model.m_spSimplexModel->getReducedCost()[m_id];
+    if (const auto column = model.m_columns[m_id]; column >= 0)
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return model.m_spSimplexModel->getReducedCost()[column];
+    }
+
+    return 0.0;
 }
 
 size_t tsplp::Variable::GetId() const { return m_id; }
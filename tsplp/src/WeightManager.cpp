@@ -6,6 +6,8 @@
 #include <xtensor/xindex_view.hpp>
 #include <xtensor/xview.hpp>
 
+#include <algorithm>
+#include <thread>
 #include <unordered_set>
 
 size_t tsplp::WeightManager::ToOriginal(size_t i) const
@@ -120,6 +122,31 @@ tsplp::WeightManager::WeightManager(
         if (!m_spDependencies->GetOutgoingSpan(e).empty())
             throw IncompatibleDependenciesException();
     }
+
+    for (size_t a = 0; a < A; ++a)
+    {
+        const auto isSameClass = [&](const std::vector<size_t>& agentClass)
+        {
+            return originalStartPositions[agentClass.front()] == originalStartPositions[a]
+                && originalEndPositions[agentClass.front()] == originalEndPositions[a];
+        };
+
+        if (const auto it = std::find_if(m_agentClasses.begin(), m_agentClasses.end(), isSameClass);
+            it != m_agentClasses.end())
+        {
+            it->push_back(a);
+        }
+        else
+        {
+            m_agentClasses.push_back({ a });
+        }
+    }
+    std::erase_if(m_agentClasses, [](const auto& agentClass) { return agentClass.size() < 2; });
+
+    // candidate sets for the heuristics, computed once and shared by all of them
+    m_spNeighborLists = std::make_unique<NeighborLists>(
+        m_weights, NeighborLists::DefaultK, NeighborLists::Measure::Weight,
+        std::thread::hardware_concurrency());
 }
 
 std::vector<std::vector<size_t>> tsplp::WeightManager::TransformPathsBack(
@@ -134,6 +161,21 @@ std::vector<std::vector<size_t>> tsplp::WeightManager::TransformPathsBack(
     return paths;
 }
 
+std::vector<std::vector<size_t>> tsplp::WeightManager::TransformPaths(
+    std::vector<std::vector<size_t>> paths) const
+{
+    for (size_t a = 0; a < paths.size(); ++a)
+    {
+        if (paths[a].empty())
+            continue;
+
+        paths[a].front() = m_startPositions[a];
+        paths[a].back() = m_endPositions[a];
+    }
+
+    return paths;
+}
+
 xt::xtensor<double, 3> tsplp::WeightManager::TransformTensorBack(
     const xt::xtensor<double, 3>& tensor) const
 {
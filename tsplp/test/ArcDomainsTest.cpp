@@ -0,0 +1,101 @@
+#include "ArcDomains.hpp"
+#include "WeightManager.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+namespace
+{
+tsplp::Variable Arc(size_t N, size_t a, size_t u, size_t v)
+{
+    return tsplp::Variable { a * N * N + u * N + v };
+}
+}
+
+TEST_CASE("arc domains single agent", "[ArcDomains]")
+{
+    constexpr size_t N = 5;
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    weights.fill(1.0);
+
+    const tsplp::WeightManager weightManager { weights, { 0 }, { 4 } };
+    auto domains = tsplp::ArcDomains { weightManager };
+
+    // the artificial arc, which forbids the one closing the subtour
+    CHECK(domains.IsFixedToOne(0, 4, 0));
+    CHECK(!domains.IsPossible(0, 0, 4));
+    CHECK(domains.IsPossible(0, 0, 1));
+    CHECK(!domains.IsPossible(0, 2, 2));
+
+    SECTION("chains are completed")
+    {
+        const std::vector fixed1 { Arc(N, 0, 0, 1), Arc(N, 0, 1, 2) };
+        REQUIRE(domains.Propagate({}, fixed1));
+
+        CHECK(!domains.IsPossible(0, 2, 0));
+        CHECK(domains.IsFixedToOne(0, 2, 3));
+        CHECK(domains.IsFixedToOne(0, 3, 4));
+    }
+
+    SECTION("subtours")
+    {
+        const std::vector fixed1 { Arc(N, 0, 1, 2), Arc(N, 0, 2, 3) };
+        REQUIRE(domains.Propagate({}, fixed1));
+        CHECK(!domains.IsPossible(0, 3, 1));
+        CHECK(domains.IsPossible(0, 3, 4));
+
+        const std::vector cycle { Arc(N, 0, 3, 1) };
+        CHECK(!domains.Propagate({}, cycle));
+    }
+
+    SECTION("degrees")
+    {
+        const std::vector fixed0 { Arc(N, 0, 0, 2), Arc(N, 0, 1, 2), Arc(N, 0, 3, 2) };
+        CHECK(!domains.Propagate(fixed0, {}));
+    }
+}
+
+TEST_CASE("arc domains dependencies", "[ArcDomains]")
+{
+    // two agents from 0 to 2 and from 1 to 3, and 4 before 5
+    constexpr size_t N = 6;
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    weights.fill(1.0);
+    weights(5, 4) = -1;
+
+    const tsplp::WeightManager weightManager { weights, { 0, 1 }, { 2, 3 } };
+    auto domains = tsplp::ArcDomains { weightManager };
+
+    for (size_t a = 0; a < 2; ++a)
+    {
+        CHECK(!domains.IsPossible(a, 5, 4));
+        CHECK(!domains.IsPossible(a, 0, 5));
+        CHECK(!domains.IsPossible(a, 1, 5));
+        CHECK(!domains.IsPossible(a, 4, 2));
+        CHECK(!domains.IsPossible(a, 4, 3));
+    }
+    CHECK(!domains.IsPossible(1, 0, 4));
+    CHECK(!domains.IsPossible(0, 5, 3));
+
+    SECTION("same agent")
+    {
+        const std::vector fixed1 { Arc(N, 1, 1, 4) };
+        REQUIRE(domains.Propagate({}, fixed1));
+
+        for (size_t n = 0; n < N; ++n)
+        {
+            CHECK(!domains.IsPossible(0, n, 5));
+            CHECK(!domains.IsPossible(0, 5, n));
+        }
+        CHECK(domains.IsFixedToOne(0, 0, 2));
+        CHECK(domains.IsFixedToOne(1, 4, 5));
+        CHECK(domains.IsFixedToOne(1, 5, 3));
+    }
+
+    SECTION("different agents")
+    {
+        const std::vector fixed1 { Arc(N, 1, 1, 4), Arc(N, 0, 5, 2) };
+        CHECK(!domains.Propagate({}, fixed1));
+    }
+}
@@ -0,0 +1,310 @@
+#include "CoordinateWeights.hpp"
+#include "DependencyHelpers.hpp"
+#include "Heuristics.hpp"
+#include "KdTree.hpp"
+#include "NeighborLists.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+struct Coordinates
+{
+    std::vector<double> X;
+    std::vector<double> Y;
+};
+
+Coordinates CreateRandomCoordinates(size_t N, double extent)
+{
+    std::mt19937_64 generator(N);
+    const auto random = [&] { return static_cast<double>(generator() % 1000000) / 1.e6 * extent; };
+
+    Coordinates coordinates;
+    for (size_t n = 0; n < N; ++n)
+    {
+        coordinates.X.push_back(random());
+        coordinates.Y.push_back(random());
+    }
+
+    return coordinates;
+}
+}
+
+TEST_CASE("coordinate weights", "[CoordinateWeights]")
+{
+    SECTION("Euc2D and Ceil2D")
+    {
+        const std::vector x { 0.0, 3.0, 1.0 };
+        const std::vector y { 0.0, 4.0, 1.0 };
+
+        const tsplp::CoordinateWeights euc { x, y, tsplp::DistanceFunction::Euc2D };
+        CHECK(euc(0, 1) == 5.0);
+        CHECK(euc(1, 0) == 5.0);
+        CHECK(euc(0, 2) == 1.0);
+        CHECK(euc(1, 1) == 0.0);
+
+        const tsplp::CoordinateWeights ceil { x, y, tsplp::DistanceFunction::Ceil2D };
+        CHECK(ceil(0, 1) == 5.0);
+        CHECK(ceil(0, 2) == 2.0);
+    }
+
+    SECTION("Att")
+    {
+        // the first two nodes of att48
+        const std::vector x { 6734.0, 2233.0, 0.0, 10.0 };
+        const std::vector y { 1453.0, 10.0, 0.0, 0.0 };
+
+        const tsplp::CoordinateWeights att { x, y, tsplp::DistanceFunction::Att };
+        CHECK(att(0, 1) == 1495.0);
+        CHECK(att(2, 3) == 4.0);
+    }
+
+    SECTION("Geo")
+    {
+        // the first three nodes of burma14
+        const std::vector x { 16.47, 16.47, 20.09 };
+        const std::vector y { 96.10, 94.44, 92.54 };
+
+        const tsplp::CoordinateWeights geo { x, y, tsplp::DistanceFunction::Geo };
+        CHECK(geo(0, 1) == 153.0);
+        CHECK(geo(0, 2) == 510.0);
+        CHECK(geo(2, 0) == 510.0);
+        CHECK(geo(0, 0) == 0.0);
+    }
+}
+
+TEST_CASE("k-d tree", "[CoordinateWeights]")
+{
+    constexpr size_t N = 500;
+    const auto [x, y] = CreateRandomCoordinates(N, 1000.0);
+    const auto distanceFunction
+        = GENERATE(tsplp::DistanceFunction::Euc2D, tsplp::DistanceFunction::Geo);
+
+    // Geo coordinates have to be valid latitudes and longitudes
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    for (size_t n = 0; n < N; ++n)
+    {
+        latitudes.push_back(x[n] / 1000.0 * 120.0 - 60.0);
+        longitudes.push_back(y[n] / 1000.0 * 300.0 - 150.0);
+    }
+
+    const auto weights = distanceFunction == tsplp::DistanceFunction::Geo
+        ? tsplp::CoordinateWeights { latitudes, longitudes, distanceFunction }
+        : tsplp::CoordinateWeights { x, y, distanceFunction };
+
+    tsplp::KdTree tree(weights);
+
+    // the tree orders by euclidean distance, so only the rounded weights can be compared
+    const auto sortedWeights = [&](size_t u, std::vector<size_t> nodes)
+    {
+        std::vector<double> result;
+        for (const auto v : nodes)
+            result.push_back(weights(u, v));
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+
+    SECTION("nearest")
+    {
+        constexpr size_t k = 8;
+        for (size_t u = 0; u < N; ++u)
+        {
+            std::vector<size_t> expected;
+            for (size_t v = 0; v < N; ++v)
+            {
+                if (v != u)
+                    expected.push_back(v);
+            }
+            std::partial_sort(
+                expected.begin(), expected.begin() + k, expected.end(),
+                [&](size_t v, size_t w) { return weights(u, v) < weights(u, w); });
+            expected.resize(k);
+
+            const auto nearest = tree.FindNearest(u, k);
+            REQUIRE(nearest.size() == k);
+            CHECK(sortedWeights(u, nearest) == sortedWeights(u, expected));
+        }
+
+        CHECK(tree.FindNearest(0, 0).empty());
+        CHECK(tree.FindNearest(0, N).size() == N - 1);
+    }
+
+    SECTION("nearest remaining")
+    {
+        std::vector<bool> isRemoved(N, false);
+        auto n = static_cast<size_t>(0);
+        tree.Remove(n);
+        isRemoved[n] = true;
+
+        for (size_t i = 1; i < N; ++i)
+        {
+            auto expectedWeight = std::numeric_limits<double>::max();
+            for (size_t v = 0; v < N; ++v)
+            {
+                if (!isRemoved[v])
+                    expectedWeight = std::min(expectedWeight, weights(n, v));
+            }
+
+            const auto next = tree.FindNearestRemaining(n);
+            REQUIRE(next < N);
+            REQUIRE(!isRemoved[next]);
+            CHECK(weights(n, next) == expectedWeight);
+
+            tree.Remove(next);
+            isRemoved[next] = true;
+            n = next;
+        }
+
+        CHECK(tree.FindNearestRemaining(n) == N);
+    }
+}
+
+TEST_CASE("neighbor lists from coordinates", "[CoordinateWeights]")
+{
+    constexpr size_t N = 300;
+    const auto [x, y] = CreateRandomCoordinates(N, 100.0);
+    const tsplp::CoordinateWeights weights { x, y, tsplp::DistanceFunction::Euc2D };
+
+    auto matrix = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+            matrix(u, v) = weights(u, v);
+    }
+
+    const tsplp::NeighborLists fromCoordinates { weights, 5, 2 };
+    const tsplp::NeighborLists fromMatrix { matrix, 5 };
+
+    // with rounded weights, ties may be resolved differently
+    const auto asWeights = [&](size_t u, std::span<const size_t> span)
+    {
+        std::vector<double> result;
+        for (const auto v : span)
+            result.push_back(weights(u, v));
+        return result;
+    };
+
+    for (size_t u = 0; u < N; ++u)
+    {
+        CHECK(
+            asWeights(u, fromCoordinates.GetOutgoingSpan(u))
+            == asWeights(u, fromMatrix.GetOutgoingSpan(u)));
+        CHECK(
+            asWeights(u, fromCoordinates.GetIncomingSpan(u))
+            == asWeights(u, fromMatrix.GetIncomingSpan(u)));
+    }
+}
+
+TEST_CASE("heuristic solve from coordinates", "[CoordinateWeights]")
+{
+    constexpr size_t N = 2000;
+    const auto [x, y] = CreateRandomCoordinates(N, 10000.0);
+    const tsplp::CoordinateWeights weights { x, y, tsplp::DistanceFunction::Ceil2D };
+
+    const xt::xtensor<size_t, 1> startPositions { 0, 1, 2 };
+    const xt::xtensor<size_t, 1> endPositions { 0, 3, 4 };
+    const auto endTime = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+    const auto optimizationMode
+        = GENERATE(tsplp::OptimizationMode::Sum, tsplp::OptimizationMode::Max);
+
+    const auto [initialPaths, initialObjective] = tsplp::NearestNeighborPaths(
+        optimizationMode, weights, startPositions, endPositions);
+    const auto [paths, objective] = tsplp::HeuristicSolve(
+        optimizationMode, weights, startPositions, endPositions, endTime, 2);
+
+    CHECK(objective == tsplp::CalculateObjective(optimizationMode, paths, weights));
+    CHECK(objective <= initialObjective);
+
+    for (const auto& solution : { initialPaths, paths })
+    {
+        REQUIRE(solution.size() == startPositions.size());
+
+        std::vector<size_t> visits(N, 0);
+        for (size_t a = 0; a < solution.size(); ++a)
+        {
+            REQUIRE(solution[a].size() >= 2);
+            CHECK(solution[a].front() == startPositions[a]);
+            CHECK(solution[a].back() == endPositions[a]);
+            for (size_t i = 1; i + 1 < solution[a].size(); ++i)
+                ++visits[solution[a][i]];
+        }
+
+        for (size_t n = 5; n < N; ++n)
+            CHECK(visits[n] == 1);
+    }
+}
+
+TEST_CASE("multilevel solve from coordinates", "[CoordinateWeights]")
+{
+    // three levels of coarsening
+    constexpr size_t N = 5000;
+    const auto [x, y] = CreateRandomCoordinates(N, 10000.0);
+    const tsplp::CoordinateWeights weights { x, y, tsplp::DistanceFunction::Euc2D };
+
+    const auto [startPositions, endPositions] = GENERATE(
+        std::pair { xt::xtensor<size_t, 1> { 0 }, xt::xtensor<size_t, 1> { 0 } },
+        std::pair { xt::xtensor<size_t, 1> { 0, 1 }, xt::xtensor<size_t, 1> { 2, 1 } });
+    const auto endTime = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+
+    const auto [initialPaths, initialObjective] = tsplp::NearestNeighborPaths(
+        tsplp::OptimizationMode::Sum, weights, startPositions, endPositions);
+    const auto [paths, objective] = tsplp::MultilevelSolve(
+        tsplp::OptimizationMode::Sum, weights, startPositions, endPositions, endTime, 4);
+
+    CHECK(objective == tsplp::CalculateObjective(tsplp::OptimizationMode::Sum, paths, weights));
+    CHECK(objective < initialObjective);
+
+    REQUIRE(paths.size() == startPositions.size());
+    std::vector<size_t> visits(N, 0);
+    for (size_t a = 0; a < paths.size(); ++a)
+    {
+        REQUIRE(paths[a].size() >= 2);
+        CHECK(paths[a].front() == startPositions[a]);
+        CHECK(paths[a].back() == endPositions[a]);
+        for (size_t i = 1; i + 1 < paths[a].size(); ++i)
+            ++visits[paths[a][i]];
+    }
+
+    for (size_t n = 3; n < N; ++n)
+        CHECK(visits[n] == 1);
+}
+
+TEST_CASE("shared depot from coordinates", "[CoordinateWeights]")
+{
+    constexpr size_t N = 500;
+    const auto [x, y] = CreateRandomCoordinates(N, 1000.0);
+    const tsplp::CoordinateWeights weights { x, y, tsplp::DistanceFunction::Euc2D };
+
+    const xt::xtensor<size_t, 1> startPositions { 0, 0, 0 };
+    const xt::xtensor<size_t, 1> endPositions { 0, 0, 0 };
+    const auto endTime = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+    const auto optimizationMode
+        = GENERATE(tsplp::OptimizationMode::Sum, tsplp::OptimizationMode::Max);
+    const auto solve = GENERATE(&tsplp::HeuristicSolve, &tsplp::MultilevelSolve);
+
+    const auto [paths, objective]
+        = solve(optimizationMode, weights, startPositions, endPositions, endTime, 2);
+
+    CHECK(objective == tsplp::CalculateObjective(optimizationMode, paths, weights));
+
+    REQUIRE(paths.size() == startPositions.size());
+    std::vector<size_t> visits(N, 0);
+    for (const auto& path : paths)
+    {
+        REQUIRE(path.size() >= 2);
+        CHECK(path.front() == 0);
+        CHECK(path.back() == 0);
+        for (size_t i = 1; i + 1 < path.size(); ++i)
+            ++visits[path[i]];
+    }
+
+    for (size_t n = 1; n < N; ++n)
+        CHECK(visits[n] == 1);
+}
@@ -0,0 +1,134 @@
+#include "DependencyHelpers.hpp"
+#include "HeldKarp.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+std::vector<tsplp::InstructionSet> GetTestedInstructionSets()
+{
+    std::vector<tsplp::InstructionSet> instructionSets { tsplp::InstructionSet::Scalar };
+    if (tsplp::GetSupportedInstructionSet() != tsplp::InstructionSet::Scalar)
+        instructionSets.push_back(tsplp::InstructionSet::Avx2);
+    if (tsplp::GetSupportedInstructionSet() == tsplp::InstructionSet::Avx512)
+        instructionSets.push_back(tsplp::InstructionSet::Avx512);
+
+    return instructionSets;
+}
+
+bool SatisfiesDependencies(
+    const std::vector<size_t>& path, const tsplp::DependencyGraph& dependencies)
+{
+    std::vector<size_t> positions(path.size());
+    for (size_t i = 0; i < path.size(); ++i)
+        positions[path[i]] = i;
+
+    return std::all_of(
+        dependencies.GetArcs().begin(), dependencies.GetArcs().end(),
+        [&](const auto& arc) { return positions[arc.first] < positions[arc.second]; });
+}
+
+double BruteForcePathLength(
+    const xt::xtensor<double, 2>& weights, size_t start, size_t end,
+    const tsplp::DependencyGraph& dependencies)
+{
+    std::vector<size_t> nodes;
+    for (size_t n = 0; n < weights.shape(0); ++n)
+    {
+        if (n != start && n != end)
+            nodes.push_back(n);
+    }
+
+    auto best = std::numeric_limits<double>::max();
+    do
+    {
+        std::vector<size_t> path { start };
+        path.insert(path.end(), nodes.begin(), nodes.end());
+        path.push_back(end);
+
+        if (!SatisfiesDependencies(path, dependencies))
+            continue;
+
+        auto length = 0.0;
+        for (size_t i = 1; i < path.size(); ++i)
+            length += weights(path[i - 1], path[i]);
+
+        best = std::min(best, length);
+    } while (std::next_permutation(nodes.begin(), nodes.end()));
+
+    return best;
+}
+}
+
+TEST_CASE("held karp", "[HeldKarp]")
+{
+    constexpr size_t N = 8;
+    constexpr size_t start = 2;
+    constexpr size_t end = 5;
+
+    const auto seed = GENERATE(range(0, 10));
+    std::mt19937_64 generator(static_cast<unsigned long>(seed));
+
+    // asymmetric, with few distinct values to provoke ties during backtracking
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+            weights(u, v) = u == v ? 0.0 : static_cast<double>(generator() % 10);
+    }
+
+    SECTION("without dependencies") { }
+
+    SECTION("with dependencies")
+    {
+        // 0 before 1 before 3, 7 before 4, and 6 before end
+        weights(1, 0) = -1;
+        weights(3, 1) = -1;
+        weights(4, 7) = -1;
+        weights(end, 6) = -1;
+    }
+
+    const tsplp::DependencyGraph dependencies { weights };
+    const auto expectedLength = BruteForcePathLength(weights, start, end, dependencies);
+
+    for (const auto instructionSet : GetTestedInstructionSets())
+    {
+        const auto [path, length] = tsplp::HeldKarpPath(
+            weights, start, end, dependencies, instructionSet);
+
+        REQUIRE(path.size() == N);
+        CHECK(path.front() == start);
+        CHECK(path.back() == end);
+        CHECK(SatisfiesDependencies(path, dependencies));
+
+        auto pathLength = 0.0;
+        for (size_t i = 1; i < path.size(); ++i)
+            pathLength += weights(path[i - 1], path[i]);
+
+        CHECK(pathLength == length);
+        CHECK(length == expectedLength);
+    }
+}
+
+TEST_CASE("held karp infeasible", "[HeldKarp]")
+{
+    constexpr size_t N = 5;
+
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    weights.fill(1.0);
+
+    // 1 before 3 and 3 before 1
+    weights(3, 1) = -1;
+    weights(1, 3) = -1;
+
+    const tsplp::DependencyGraph dependencies { weights };
+    const auto [path, length] = tsplp::HeldKarpPath(weights, 0, 4, dependencies);
+
+    CHECK(path.empty());
+    CHECK(length == std::numeric_limits<double>::max());
+}
@@ -1,8 +1,17 @@
 #include "Heuristics.hpp"
+#include "NeighborLists.hpp"
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <string>
+#include <utility>
 #include <vector>
 
 using namespace std::chrono_literals;
@@ -28,6 +37,50 @@ TEST_CASE("path length", "[Heuristics]")
     CHECK(tsplp::CalculatePathLength({}, weights) == 0);
 }
 
+TEST_CASE("agent weights", "[Heuristics]")
+{
+    // clang-format off
+    const xt::xtensor<double, 2> weights =
+    {
+        { 0, 2, 3 },
+        { 2, 0, 6 },
+        { 4, 5, 0 }
+    };
+
+    const xt::xtensor<double, 3> fractionalSolution =
+    {
+        {
+            { 0, 1, 0 },
+            { 0, 0, 0.5 },
+            { 1, 0, 0 }
+        },
+        {
+            { 0, 0, 0.25 },
+            { 0, 0, 0 },
+            { 0, 0, 0 }
+        }
+    };
+    // clang-format on
+
+    const tsplp::AgentWeights plain = weights;
+    const tsplp::AgentWeights scaled { weights, fractionalSolution };
+
+    CHECK(plain.N() == 3);
+    CHECK(scaled.N() == 3);
+
+    for (size_t a = 0; a < 2; ++a)
+    {
+        for (size_t u = 0; u < 3; ++u)
+        {
+            for (size_t v = 0; v < 3; ++v)
+            {
+                CHECK(plain(a, u, v) == weights(u, v));
+                CHECK(scaled(a, u, v) == (1.0 - fractionalSolution(a, u, v)) * weights(u, v));
+            }
+        }
+    }
+}
+
 TEST_CASE("objective A==1", "[Heuristics]")
 {
     // clang-format off
@@ -348,6 +401,47 @@ TEST_CASE("nearest insertion A==2", "[Heuristics]")
     }
 }
 
+TEST_CASE("nearest insertion A==2 with neighbor lists", "[Heuristics]")
+{
+    // clang-format off
+    const xt::xtensor<double, 2> weights =
+    {
+        { 0, 2, 3, 4, 0, 2, 3, 4 },
+        { 2, 0, 6, 8, 2, 0, 6, 8 },
+        { 4, 5, 0, 7, 4, 5, 0, 7 },
+        { 0, 1, 2, 0, 0, 1, 2, 0 },
+        { 0, 2, 3, 4, 0, 2, 3, 4 },
+        { 2, 0, 6, 8, 2, 0, 6, 8 },
+        { 4, 5, 0, 7, 4, 5, 0, 7 },
+        { 0, 1, 2, 0, 0, 1, 2, 0 }
+    };
+    // clang-format on
+
+    const xt::xtensor<size_t, 1> startPositions = { 7, 3 };
+    const xt::xtensor<size_t, 1> endPositions = { 4, 0 };
+    const tsplp::DependencyGraph dependencies { weights };
+
+    for (const auto mode : { tsplp::OptimizationMode::Sum, tsplp::OptimizationMode::Max })
+    {
+        const auto endTime = std::chrono::steady_clock::now() + 1h;
+        const auto expected = tsplp::NearestInsertion(
+            mode, weights, startPositions, endPositions, dependencies, endTime);
+
+        // all nodes are neighbors, so all positions are still considered
+        const tsplp::NeighborLists allNeighbors { weights, 8 };
+        CHECK(
+            tsplp::NearestInsertion(
+                mode, weights, startPositions, endPositions, dependencies, endTime, &allNeighbors)
+            == expected);
+
+        const tsplp::NeighborLists nearestNeighbor { weights, 1 };
+        const auto [paths, objective] = tsplp::NearestInsertion(
+            mode, weights, startPositions, endPositions, dependencies, endTime, &nearestNeighbor);
+        CHECK(objective == tsplp::CalculateObjective(mode, paths, weights));
+        CHECK(paths[0].size() + paths[1].size() == 8);
+    }
+}
+
 TEST_CASE("nearest insertion A==1 with dependencies", "[Heuristics]")
 {
     // 3->1->2
@@ -438,3 +532,652 @@ TEST_CASE("nearest insertion A==2 with dependencies", "[Heuristics]")
         CHECK(paths == expectedPaths);
     }
 }
+
+TEST_CASE("local search A==1", "[Heuristics]")
+{
+    // node 4 is a copy of node 0, just like WeightManager would create it
+    // clang-format off
+    const xt::xtensor<double, 2> weights =
+    {
+        { 0, 2, 3, 4, 0 },
+        { 2, 0, 6, 8, 2 },
+        { 4, 5, 0, 7, 4 },
+        { 0, 1, 2, 0, 0 },
+        { 0, 2, 3, 4, 0 }
+    };
+    // clang-format on
+
+    const tsplp::DependencyGraph dependencies { weights };
+    const tsplp::NeighborLists neighborLists { weights };
+    const std::vector<std::vector<size_t>> paths = { { 0, 1, 3, 2, 4 } };
+
+    for (const auto mode : { tsplp::OptimizationMode::Sum, tsplp::OptimizationMode::Max })
+    {
+        const auto [optPaths, improvement] = tsplp::LocalSearchPaths(
+            mode, paths, weights, dependencies, neighborLists,
+            std::chrono::steady_clock::now() + 1h);
+        // { { 0, 1, 3, 2, 4 } } => 2 + 8 + 2 + 4
+        // optimal: { { 0, 2, 3, 1, 4 } } => 3 + 7 + 1 + 2 or { { 0, 3, 2, 1, 4 } } => 4 + 2 + 5 + 2
+        CHECK(improvement == 3);
+        CHECK(tsplp::CalculateObjective(mode, optPaths, weights) == 13);
+        CHECK(optPaths[0].front() == 0);
+        CHECK(optPaths[0].back() == 4);
+    }
+}
+
+TEST_CASE("local search A==1 with dependencies", "[Heuristics]")
+{
+    // 1 -> 3
+    // clang-format off
+    const xt::xtensor<double, 2> weights =
+    {
+        { 0, 2, 3, 4, 0 },
+        { 2, 0, 6, 8, 2 },
+        { 4, 5, 0, 7, 4 },
+        { 0,-1, 2, 0, 0 },
+        { 0, 2, 3, 4, 0 }
+    };
+    // clang-format on
+
+    const tsplp::DependencyGraph dependencies { weights };
+    const tsplp::NeighborLists neighborLists { weights };
+    const std::vector<std::vector<size_t>> paths = { { 0, 1, 3, 2, 4 } };
+
+    const auto [optPaths, improvement] = tsplp::LocalSearchPaths(
+        tsplp::OptimizationMode::Sum, paths, weights, dependencies, neighborLists,
+        std::chrono::steady_clock::now() + 1h);
+    // { { 0, 1, 3, 2, 4 } } => 2 + 8 + 2 + 4
+    // { { 0, 1, 2, 3, 4 } } => 2 + 6 + 7 + 0
+    const std::vector<std::vector<size_t>> expectedPaths = { { 0, 1, 2, 3, 4 } };
+    CHECK(improvement == 1);
+    CHECK(optPaths == expectedPaths);
+}
+
+TEST_CASE("local search A==2", "[Heuristics]")
+{
+    // clang-format off
+    const xt::xtensor<double, 2> weights =
+    {
+        { 0, 2, 3, 4, 0, 9, 9, 9 },
+        { 2, 0, 6, 8, 2, 9, 9, 9 },
+        { 4, 5, 0, 7, 4, 9, 9, 9 },
+        { 0, 1, 2, 0, 0, 9, 9, 9 },
+        { 0, 2, 3, 4, 0, 9, 9, 9 },
+        { 9, 9, 9, 9, 9, 0, 1, 5 },
+        { 9, 9, 9, 9, 9, 5, 0, 1 },
+        { 9, 9, 9, 9, 9, 1, 5, 0 }
+    };
+    // clang-format on
+
+    const tsplp::DependencyGraph dependencies { weights };
+    const tsplp::NeighborLists neighborLists { weights, 3 };
+    const std::vector<std::vector<size_t>> paths = { { 0, 1, 3, 2, 4 }, { 5, 7, 6 } };
+
+    {
+        const auto [optPaths, improvement] = tsplp::LocalSearchPaths(
+            tsplp::OptimizationMode::Sum, paths, weights, dependencies, neighborLists,
+            std::chrono::steady_clock::now() + 1h);
+        // { { 0, 1, 3, 2, 4 }, { 5, 7, 6 } } => 16 + 10
+        // { { 0, 3, 2, 1, 4 }, { 5, 7, 6 } } => 13 + 10
+        CHECK(improvement == 3);
+        CHECK(tsplp::CalculateObjective(tsplp::OptimizationMode::Sum, optPaths, weights) == 23);
+        CHECK(optPaths[1] == paths[1]);
+    }
+    {
+        const auto [optPaths, improvement] = tsplp::LocalSearchPaths(
+            tsplp::OptimizationMode::Max, paths, weights, dependencies, neighborLists,
+            std::chrono::steady_clock::now() + 1h);
+        // { { 0, 1, 3, 2, 4 }, { 5, 7, 6 } } => 16, 10
+        // { { 0, 3, 2, 1, 4 }, { 5, 7, 6 } } => 13, 10
+        CHECK(improvement == 3);
+        CHECK(tsplp::CalculateObjective(tsplp::OptimizationMode::Max, optPaths, weights) == 13);
+    }
+}
+
+TEST_CASE("local search A==1 asymmetric", "[Heuristics]")
+{
+    // traversing 1, 2, 3 is cheap backwards but expensive forwards
+    // clang-format off
+    const xt::xtensor<double, 2> weights =
+    {
+        { 0, 5, 9, 1, 9, 0 },
+        { 9, 0, 9, 9, 1, 9 },
+        { 9, 1, 0, 9, 9, 9 },
+        { 9, 9, 1, 0, 5, 9 },
+        { 0, 9, 9, 9, 0, 0 },
+        { 0, 5, 9, 1, 9, 0 }
+    };
+    // clang-format on
+
+    const tsplp::DependencyGraph dependencies { weights };
+    const tsplp::NeighborLists neighborLists { weights };
+    const std::vector<std::vector<size_t>> expectedPaths = { { 0, 3, 2, 1, 4, 5 } };
+
+    {
+        // 2-opt: reversal of 1, 2, 3
+        const std::vector<std::vector<size_t>> paths = { { 0, 1, 2, 3, 4, 5 } };
+        const auto [optPaths, improvement] = tsplp::LocalSearchPaths(
+            tsplp::OptimizationMode::Sum, paths, weights, dependencies, neighborLists,
+            std::chrono::steady_clock::now() + 1h);
+        // { { 0, 1, 2, 3, 4, 5 } } => 5 + 9 + 9 + 5 + 0
+        // { { 0, 3, 2, 1, 4, 5 } } => 1 + 1 + 1 + 1 + 0
+        CHECK(improvement == 24);
+        CHECK(optPaths == expectedPaths);
+    }
+    {
+        // Or-opt: relocation of 1, 2, 3 in front of 4 as 3, 2, 1
+        const std::vector<std::vector<size_t>> paths = { { 0, 4, 1, 2, 3, 5 } };
+        const auto [optPaths, improvement] = tsplp::LocalSearchPaths(
+            tsplp::OptimizationMode::Sum, paths, weights, dependencies, neighborLists,
+            std::chrono::steady_clock::now() + 1h);
+        // { { 0, 4, 1, 2, 3, 5 } } => 9 + 9 + 9 + 9 + 9
+        CHECK(improvement == 41);
+        CHECK(optPaths == expectedPaths);
+    }
+}
+
+TEST_CASE("local search A==2 between paths", "[Heuristics]")
+{
+    // nodes on a line, agents start at 0 and 10, 2 and 3 are copies of 0 and 1
+    // clang-format off
+    const xt::xtensor<double, 2> weights =
+    {
+        {  0, 10,  0, 10,  4,  6 },
+        { 10,  0, 10,  0,  6,  4 },
+        {  0, 10,  0, 10,  4,  6 },
+        { 10,  0, 10,  0,  6,  4 },
+        {  4,  6,  4,  6,  0,  2 },
+        {  6,  4,  6,  4,  2,  0 }
+    };
+    // clang-format on
+
+    const tsplp::DependencyGraph dependencies { weights };
+    const tsplp::NeighborLists neighborLists { weights };
+
+    {
+        // relocation of 5
+        const std::vector<std::vector<size_t>> paths = { { 0, 4, 5, 2 }, { 1, 3 } };
+
+        const auto [sumPaths, sumImprovement] = tsplp::LocalSearchPaths(
+            tsplp::OptimizationMode::Sum, paths, weights, dependencies, neighborLists,
+            std::chrono::steady_clock::now() + 1h);
+        CHECK(sumImprovement == 0);
+        CHECK(sumPaths == paths);
+
+        const auto [maxPaths, maxImprovement] = tsplp::LocalSearchPaths(
+            tsplp::OptimizationMode::Max, paths, weights, dependencies, neighborLists,
+            std::chrono::steady_clock::now() + 1h);
+        // { { 0, 4, 5, 2 }, { 1, 3 } } => 12, 0
+        // { { 0, 4, 2 }, { 1, 5, 3 } } => 8, 8
+        const std::vector<std::vector<size_t>> expectedPaths = { { 0, 4, 2 }, { 1, 5, 3 } };
+        CHECK(maxImprovement == 4);
+        CHECK(maxPaths == expectedPaths);
+    }
+    {
+        // exchange of 4 and 5, no relocation shortens the longer path
+        const std::vector<std::vector<size_t>> paths = { { 0, 5, 2 }, { 1, 4, 3 } };
+
+        const auto [maxPaths, maxImprovement] = tsplp::LocalSearchPaths(
+            tsplp::OptimizationMode::Max, paths, weights, dependencies, neighborLists,
+            std::chrono::steady_clock::now() + 1h);
+        // { { 0, 5, 2 }, { 1, 4, 3 } } => 12, 12
+        // { { 0, 4, 2 }, { 1, 5, 3 } } => 8, 8
+        const std::vector<std::vector<size_t>> expectedPaths = { { 0, 4, 2 }, { 1, 5, 3 } };
+        CHECK(maxImprovement == 4);
+        CHECK(maxPaths == expectedPaths);
+    }
+}
+
+TEST_CASE("local search A==2 between paths with dependencies", "[Heuristics]")
+{
+    // 4 -> 5
+    // clang-format off
+    const xt::xtensor<double, 2> weights =
+    {
+        {  0, 10,  0, 10,  4,  6 },
+        { 10,  0, 10,  0,  6,  4 },
+        {  0, 10,  0, 10,  4,  6 },
+        { 10,  0, 10,  0,  6,  4 },
+        {  4,  6,  4,  6,  0,  2 },
+        {  6,  4,  6,  4, -1,  0 }
+    };
+    // clang-format on
+
+    const tsplp::DependencyGraph dependencies { weights };
+    const tsplp::NeighborLists neighborLists { weights };
+    const std::vector<std::vector<size_t>> paths = { { 0, 4, 5, 2 }, { 1, 3 } };
+
+    const auto [optPaths, improvement] = tsplp::LocalSearchPaths(
+        tsplp::OptimizationMode::Max, paths, weights, dependencies, neighborLists,
+        std::chrono::steady_clock::now() + 1h);
+    CHECK(improvement == 0);
+    CHECK(optPaths == paths);
+}
+
+TEST_CASE("local search A==1 convex", "[Heuristics]")
+{
+    // 19 points on the unit circle, node 0 is at angle 0 and node 19 is a copy of it
+    constexpr size_t numberOfPoints = 19;
+    const auto angle
+        = [](size_t n) { return 2 * std::numbers::pi * static_cast<double>(n) / numberOfPoints; };
+
+    xt::xtensor<double, 2> weights({ numberOfPoints + 1, numberOfPoints + 1 }, 0.0);
+    for (size_t u = 0; u <= numberOfPoints; ++u)
+    {
+        for (size_t v = 0; v <= numberOfPoints; ++v)
+        {
+            weights(u, v) = std::hypot(
+                std::cos(angle(u)) - std::cos(angle(v)), std::sin(angle(u)) - std::sin(angle(v)));
+        }
+    }
+
+    std::vector<std::vector<size_t>> paths = { { 0 } };
+    for (size_t k = 1; k < numberOfPoints; ++k)
+        paths[0].push_back(1 + k * 7 % (numberOfPoints - 1));
+    paths[0].push_back(numberOfPoints);
+
+    const tsplp::DependencyGraph dependencies { weights };
+    const tsplp::NeighborLists neighborLists { weights };
+
+    const auto [optPaths, improvement] = tsplp::LocalSearchPaths(
+        tsplp::OptimizationMode::Sum, paths, weights, dependencies, neighborLists,
+        std::chrono::steady_clock::now() + 1h);
+
+    // the optimal path visits the points along the circle
+    const auto perimeter = numberOfPoints * 2 * std::sin(std::numbers::pi / numberOfPoints);
+    CHECK(tsplp::CalculateObjective(tsplp::OptimizationMode::Sum, optPaths, weights)
+          == Approx(perimeter));
+    CHECK(tsplp::CalculateObjective(tsplp::OptimizationMode::Sum, paths, weights) - improvement
+          == Approx(perimeter));
+}
+
+TEST_CASE("cheapest insertion A==1", "[Heuristics]")
+{
+    // clang-format off
+    xt::xarray<double> weights =
+    {
+        { 0, 2, 3, 4 },
+        { 2, 0, 6, 8 },
+        { 4, 5, 0, 7 },
+        { 0, 1, 2, 0 }
+    };
+    // clang-format on
+
+    const xt::xtensor<size_t, 1> startPositions = { 3 };
+    const xt::xtensor<size_t, 1> endPositions = { 0 };
+    const std::vector<std::vector<size_t>> expectedPaths = { { 3, 2, 1, 0 } };
+
+    for (const auto mode : { tsplp::OptimizationMode::Sum, tsplp::OptimizationMode::Max })
+    {
+        const auto [paths, objective] = tsplp::CheapestInsertion(
+            mode, weights, startPositions, endPositions, tsplp::DependencyGraph { weights },
+            std::chrono::steady_clock::now() + 1h);
+        // expected insertions
+        // { { 3, 0 } } => 0
+        // { { 3, 1, 0 } } => 1 + 2 (cheaper than 2 + 4 for node 2)
+        // { { 3, 2, 1, 0 } } => 2 + 5 + 2
+        CHECK(objective == 9);
+        CHECK(paths == expectedPaths);
+    }
+}
+
+TEST_CASE("cheapest insertion A==2", "[Heuristics]")
+{
+    // clang-format off
+    xt::xarray<double> weights =
+    {
+        { 0, 2, 3, 4, 0, 2, 3, 4 },
+        { 2, 0, 6, 8, 2, 0, 6, 8 },
+        { 4, 5, 0, 7, 4, 5, 0, 7 },
+        { 0, 1, 2, 0, 0, 1, 2, 0 },
+        { 0, 2, 3, 4, 0, 2, 3, 4 },
+        { 2, 0, 6, 8, 2, 0, 6, 8 },
+        { 4, 5, 0, 7, 4, 5, 0, 7 },
+        { 0, 1, 2, 0, 0, 1, 2, 0 }
+    };
+    // clang-format on
+
+    const xt::xtensor<size_t, 1> startPositions = { 7, 3 };
+    const xt::xtensor<size_t, 1> endPositions = { 4, 0 };
+
+    {
+        const auto [paths, objective] = tsplp::CheapestInsertion(
+            tsplp::OptimizationMode::Sum, weights, startPositions, endPositions,
+            tsplp::DependencyGraph { weights }, std::chrono::steady_clock::now() + 1h);
+        // expected insertions (ties are broken by the smaller node)
+        // { { 7, 4 }, { 3, 0 } } => 0, 0
+        // { { 7, 1, 4 }, { 3, 0 } } => 1 + 2, 0
+        // { { 7, 5, 1, 4 }, { 3, 0 } } => 1 + 0 + 2, 0
+        // { { 7, 2, 5, 1, 4 }, { 3, 0 } } => 2 + 5 + 0 + 2, 0
+        // { { 7, 6, 2, 5, 1, 4 }, { 3, 0 } } => 2 + 0 + 5 + 0 + 2, 0
+        const std::vector<std::vector<size_t>> expectedPaths = { { 7, 6, 2, 5, 1, 4 }, { 3, 0 } };
+        CHECK(objective == 9);
+        CHECK(paths == expectedPaths);
+    }
+    {
+        const auto [paths, objective] = tsplp::CheapestInsertion(
+            tsplp::OptimizationMode::Max, weights, startPositions, endPositions,
+            tsplp::DependencyGraph { weights }, std::chrono::steady_clock::now() + 1h);
+        CHECK(objective == tsplp::CalculateObjective(tsplp::OptimizationMode::Max, paths, weights));
+        CHECK(objective <= 6);
+        CHECK(paths[0].size() + paths[1].size() == 8);
+    }
+}
+
+TEST_CASE("cheapest insertion A==2 with dependencies", "[Heuristics]")
+{
+    // 3->1->2
+    // clang-format off
+    xt::xarray<double> weights =
+    {
+        { 0, 2, 3, 4, 0, 2, 3, 4 },
+        { 2, 0, 6,-1, 2, 0, 6, 8 },
+        { 4,-1, 0, 7, 4, 5, 0, 7 },
+        { 0, 1, 2, 0, 0, 1, 2, 0 },
+        { 0, 2, 3, 4, 0, 2, 3, 4 },
+        { 2, 0, 6, 8, 2, 0, 6, 8 },
+        { 4, 5, 0, 7, 4, 5, 0, 7 },
+        { 0, 1, 2, 0, 0, 1, 2, 0 }
+    };
+    // clang-format on
+
+    const xt::xtensor<size_t, 1> startPositions = { 7, 3 };
+    const xt::xtensor<size_t, 1> endPositions = { 4, 0 };
+
+    for (const auto mode : { tsplp::OptimizationMode::Sum, tsplp::OptimizationMode::Max })
+    {
+        const auto [paths, objective] = tsplp::CheapestInsertion(
+            mode, weights, startPositions, endPositions, tsplp::DependencyGraph { weights },
+            std::chrono::steady_clock::now() + 1h);
+
+        CHECK(objective == tsplp::CalculateObjective(mode, paths, weights));
+
+        // 1 and 2 are in the path starting at 3, in this order
+        const auto& path = paths[1];
+        const auto it1 = std::find(path.begin(), path.end(), 1);
+        const auto it2 = std::find(path.begin(), path.end(), 2);
+        REQUIRE(it1 != path.end());
+        REQUIRE(it2 != path.end());
+        CHECK(it1 < it2);
+    }
+}
+
+TEST_CASE("randomized insertion A==2 with dependencies", "[Heuristics]")
+{
+    // 3->1->2
+    // clang-format off
+    xt::xarray<double> weights =
+    {
+        { 0, 2, 3, 4, 0, 2, 3, 4 },
+        { 2, 0, 6,-1, 2, 0, 6, 8 },
+        { 4,-1, 0, 7, 4, 5, 0, 7 },
+        { 0, 1, 2, 0, 0, 1, 2, 0 },
+        { 0, 2, 3, 4, 0, 2, 3, 4 },
+        { 2, 0, 6, 8, 2, 0, 6, 8 },
+        { 4, 5, 0, 7, 4, 5, 0, 7 },
+        { 0, 1, 2, 0, 0, 1, 2, 0 }
+    };
+    // clang-format on
+
+    const xt::xtensor<size_t, 1> startPositions = { 7, 3 };
+    const xt::xtensor<size_t, 1> endPositions = { 4, 0 };
+
+    const auto criterion = GENERATE(
+        tsplp::InsertionCriterion::Cheapest, tsplp::InsertionCriterion::Farthest,
+        tsplp::InsertionCriterion::Regret);
+
+    for (const auto mode : { tsplp::OptimizationMode::Sum, tsplp::OptimizationMode::Max })
+    {
+        for (std::uint64_t seed = 0; seed < 10; ++seed)
+        {
+            const auto [paths, objective] = tsplp::RandomizedInsertion(
+                mode, weights, startPositions, endPositions, tsplp::DependencyGraph { weights },
+                criterion, seed, 0.5, std::chrono::steady_clock::now() + 1h);
+
+            CHECK(objective == tsplp::CalculateObjective(mode, paths, weights));
+            REQUIRE(paths.size() == 2);
+            CHECK(paths[0].size() + paths[1].size() == 8);
+
+            // 1 and 2 are in the path starting at 3, in this order
+            const auto& path = paths[1];
+            const auto it1 = std::find(path.begin(), path.end(), 1);
+            const auto it2 = std::find(path.begin(), path.end(), 2);
+            REQUIRE(it1 != path.end());
+            REQUIRE(it2 != path.end());
+            CHECK(it1 < it2);
+        }
+    }
+}
+
+TEST_CASE("regret insertion A==1", "[Heuristics]")
+{
+    const std::vector<std::pair<double, double>> points { { 7, 9 }, { 5, 4 }, { 2, 2 },
+                                                          { 0, 5 }, { 8, 7 }, { 9, 1 } };
+    const auto N = points.size();
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+        {
+            const auto dx = points[u].first - points[v].first;
+            const auto dy = points[u].second - points[v].second;
+            weights(u, v) = std::hypot(dx, dy);
+        }
+    }
+
+    const xt::xtensor<size_t, 1> startPositions = { 0 };
+    const xt::xtensor<size_t, 1> endPositions = { 1 };
+    const tsplp::DependencyGraph dependencies { weights };
+    const auto endTime = std::chrono::steady_clock::now() + 1h;
+
+    // each node at its cheapest position, in the order of the indices
+    std::vector<size_t> indexOrderPath { 0, 1 };
+    for (size_t n = 2; n < N; ++n)
+    {
+        size_t bestPosition = 1;
+        auto bestDelta = std::numeric_limits<double>::max();
+        for (size_t i = 1; i < indexOrderPath.size(); ++i)
+        {
+            const auto delta = weights(indexOrderPath[i - 1], n) + weights(n, indexOrderPath[i])
+                - weights(indexOrderPath[i - 1], indexOrderPath[i]);
+            if (delta < bestDelta)
+            {
+                bestDelta = delta;
+                bestPosition = i;
+            }
+        }
+
+        indexOrderPath.insert(
+            indexOrderPath.begin() + static_cast<std::ptrdiff_t>(bestPosition), n);
+    }
+
+    const auto [regretPaths, regretObjective] = tsplp::RandomizedInsertion(
+        tsplp::OptimizationMode::Sum, weights, startPositions, endPositions, dependencies,
+        tsplp::InsertionCriterion::Regret, 0, 0.0, endTime);
+    const auto [cheapestPaths, cheapestObjective] = tsplp::RandomizedInsertion(
+        tsplp::OptimizationMode::Sum, weights, startPositions, endPositions, dependencies,
+        tsplp::InsertionCriterion::Cheapest, 0, 0.0, endTime);
+
+    // without a second path, regret falls back to cheapest insertion
+    CHECK(regretPaths == cheapestPaths);
+    CHECK(regretObjective == cheapestObjective);
+    CHECK(regretObjective < tsplp::CalculatePathLength(indexOrderPath, weights));
+}
+
+TEST_CASE("savings A==3", "[Heuristics]")
+{
+    // the nodes of a regular polygon, the agents start and end at the first three nodes
+    constexpr size_t N = 30;
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+        {
+            const auto angle = std::numbers::pi * static_cast<double>(u + N - v) / N;
+            weights(u, v) = std::round(100.0 * std::abs(std::sin(angle)));
+        }
+    }
+
+    const xt::xtensor<size_t, 1> startPositions = { 0, 10, 20 };
+    const xt::xtensor<size_t, 1> endPositions = { 0, 10, 20 };
+    const tsplp::NeighborLists neighborLists { weights, 5 };
+
+    for (const auto mode : { tsplp::OptimizationMode::Sum, tsplp::OptimizationMode::Max })
+    {
+        for (std::uint64_t seed = 0; seed < 10; ++seed)
+        {
+            const auto [paths, objective] = tsplp::SavingsPaths(
+                mode, weights, startPositions, endPositions, neighborLists, seed, 0.2,
+                std::chrono::steady_clock::now() + 1h);
+
+            CHECK(objective == tsplp::CalculateObjective(mode, paths, weights));
+            REQUIRE(paths.size() == 3);
+
+            std::vector<size_t> visits(N, 0);
+            for (size_t a = 0; a < paths.size(); ++a)
+            {
+                REQUIRE(paths[a].size() >= 2);
+                CHECK(paths[a].front() == startPositions[a]);
+                CHECK(paths[a].back() == endPositions[a]);
+                for (size_t i = 1; i + 1 < paths[a].size(); ++i)
+                    ++visits[paths[a][i]];
+            }
+
+            for (size_t n = 0; n < N; ++n)
+                CHECK(visits[n] == (n % 10 == 0 ? 0 : 1));
+        }
+    }
+}
+
+TEST_CASE("large neighborhood search A==2 with dependencies", "[Heuristics]")
+{
+    // 3->1->2
+    // clang-format off
+    xt::xarray<double> weights =
+    {
+        { 0, 2, 3, 4, 0, 2, 3, 4 },
+        { 2, 0, 6,-1, 2, 0, 6, 8 },
+        { 4,-1, 0, 7, 4, 5, 0, 7 },
+        { 0, 1, 2, 0, 0, 1, 2, 0 },
+        { 0, 2, 3, 4, 0, 2, 3, 4 },
+        { 2, 0, 6, 8, 2, 0, 6, 8 },
+        { 4, 5, 0, 7, 4, 5, 0, 7 },
+        { 0, 1, 2, 0, 0, 1, 2, 0 }
+    };
+    // clang-format on
+
+    const xt::xtensor<size_t, 1> startPositions = { 7, 3 };
+    const xt::xtensor<size_t, 1> endPositions = { 4, 0 };
+    const tsplp::DependencyGraph dependencies { weights };
+    const tsplp::NeighborLists neighborLists { weights };
+
+    for (const auto mode : { tsplp::OptimizationMode::Sum, tsplp::OptimizationMode::Max })
+    {
+        auto [initialPaths, initialObjective] = tsplp::CheapestInsertion(
+            mode, weights, startPositions, endPositions, dependencies,
+            std::chrono::steady_clock::now() + 1h);
+
+        const auto [paths, objective] = tsplp::LargeNeighborhoodSearch(
+            mode, std::move(initialPaths), weights, dependencies, neighborLists,
+            std::chrono::steady_clock::now() + 100ms, 2);
+
+        CHECK(objective == tsplp::CalculateObjective(mode, paths, weights));
+        CHECK(objective <= initialObjective);
+        REQUIRE(paths.size() == 2);
+        CHECK(paths[0].size() + paths[1].size() == 8);
+
+        // 1 and 2 are in the path starting at 3, in this order
+        const auto& path = paths[1];
+        const auto it1 = std::find(path.begin(), path.end(), 1);
+        const auto it2 = std::find(path.begin(), path.end(), 2);
+        REQUIRE(it1 != path.end());
+        REQUIRE(it2 != path.end());
+        CHECK(it1 < it2);
+    }
+}
+
+TEST_CASE("balanced clusters A==2", "[Heuristics]")
+{
+    // Nodes on a line with the depot in the middle, 1 to 10 on the right and 11 to 20 on the left.
+    // Like in the weight manager, each agent has its own copy of the depot, 0 or 21.
+    constexpr size_t N = 22;
+    const auto position = [](size_t n)
+    {
+        const auto x = static_cast<double>(n);
+        return n <= 10 ? x : n <= 20 ? 10.0 - x : 0.0;
+    };
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+            weights(u, v) = std::abs(position(u) - position(v));
+    }
+
+    const xt::xtensor<size_t, 1> startPositions = { 0, 21 };
+    const xt::xtensor<size_t, 1> endPositions = { 0, 21 };
+
+    SECTION("without dependencies")
+    {
+        auto clusters = tsplp::BalancedClusters(
+            weights, startPositions, endPositions, tsplp::DependencyGraph { weights });
+
+        REQUIRE(clusters.size() == 2);
+        for (auto& cluster : clusters)
+            std::sort(cluster.begin(), cluster.end());
+        std::sort(clusters.begin(), clusters.end());
+
+        CHECK(clusters[0] == std::vector<size_t> { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 });
+        CHECK(clusters[1] == std::vector<size_t> { 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 });
+    }
+
+    SECTION("with dependencies")
+    {
+        // 1 before 15, so they have to be in the same cluster
+        weights(15, 1) = -1;
+        const auto clusters = tsplp::BalancedClusters(
+            weights, startPositions, endPositions, tsplp::DependencyGraph { weights });
+
+        REQUIRE(clusters.size() == 2);
+        const auto size0 = clusters[0].size();
+        const auto size1 = clusters[1].size();
+        CHECK(size0 + size1 == N - 2);
+        CHECK(std::max(size0, size1) - std::min(size0, size1) <= 2);
+
+        for (const auto& cluster : clusters)
+        {
+            const auto has1 = std::find(cluster.begin(), cluster.end(), 1) != cluster.end();
+            const auto has15 = std::find(cluster.begin(), cluster.end(), 15) != cluster.end();
+            CHECK(has1 == has15);
+        }
+    }
+}
+
+TEST_CASE("heuristics call overhead", "[.][benchmark][Heuristics]")
+{
+    // The weights are only viewed, so the costs do not depend on N.
+    const auto N = GENERATE(as<size_t> {}, 100, 1000, 4000);
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    weights.fill(1.0);
+    for (size_t n = 0; n < N; ++n)
+        weights(n, n) = 0.0;
+
+    const std::vector<std::vector<size_t>> paths { { 0, 1, 2, 3, 4, 0 }, { 5, 6, 7, 8, 9, 5 } };
+    const tsplp::DependencyGraph dependencies { weights };
+
+    BENCHMARK("path length, N = " + std::to_string(N))
+    {
+        return tsplp::CalculatePathLength(paths[0], weights);
+    };
+
+    BENCHMARK("objective, N = " + std::to_string(N))
+    {
+        return tsplp::CalculateObjective(tsplp::OptimizationMode::Max, paths, weights);
+    };
+
+    BENCHMARK("2-opt, N = " + std::to_string(N))
+    {
+        return tsplp::TwoOptPaths(
+            tsplp::OptimizationMode::Sum, paths, weights, dependencies,
+            std::chrono::steady_clock::now() + 1h);
+    };
+}
@@ -0,0 +1,112 @@
+#include "InsertionKernels.hpp"
+
+#include <catch2/catch.hpp>
+#include <xtensor/xnpy.hpp>
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::vector<tsplp::InstructionSet> GetTestedInstructionSets()
+{
+    std::vector<tsplp::InstructionSet> instructionSets { tsplp::InstructionSet::Scalar };
+    if (tsplp::GetSupportedInstructionSet() != tsplp::InstructionSet::Scalar)
+        instructionSets.push_back(tsplp::InstructionSet::Avx2);
+    if (tsplp::GetSupportedInstructionSet() == tsplp::InstructionSet::Avx512)
+        instructionSets.push_back(tsplp::InstructionSet::Avx512);
+
+    return instructionSets;
+}
+}
+
+TEST_CASE("cheapest insertion position", "[InsertionKernels]")
+{
+    // long enough to be vectorized
+    constexpr size_t N = 601;
+    constexpr size_t A = 2;
+
+    // few distinct values, so there are many ties
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    auto fractionalSolution = xt::xtensor<double, 3>::from_shape({ A, N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+        {
+            weights(u, v) = u == v ? 0.0 : static_cast<double>((u * 7 + v * 13) % 5);
+            for (size_t a = 0; a < A; ++a)
+                fractionalSolution(a, u, v) = static_cast<double>((u + v + a) % 3) / 2.0;
+        }
+    }
+
+    // the same weights, viewed through the transposed strides of the transposed matrix
+    auto transposedWeights = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+            transposedWeights(v, u) = weights(u, v);
+    }
+    const tsplp::WeightsView transposedView { transposedWeights.data(), N, 1, N };
+
+    std::vector<size_t> path;
+    for (size_t i = 0; i < N - 1; ++i)
+        path.push_back(i * 7 % (N - 1));
+
+    const auto n = N - 1;
+    const auto instructionSets = GetTestedInstructionSets();
+
+    for (const auto& agentWeights :
+         { tsplp::AgentWeights { weights }, tsplp::AgentWeights { weights, fractionalSolution },
+           tsplp::AgentWeights { transposedView, fractionalSolution } })
+    {
+        for (size_t a = 0; a < A; ++a)
+        {
+            for (size_t first = 1; first <= path.size(); ++first)
+            {
+                tsplp::InsertionPosition expected;
+                expected.Position = path.size();
+                for (auto i = first; i < path.size(); ++i)
+                {
+                    const auto delta = agentWeights(a, path[i - 1], n) + agentWeights(a, n, path[i])
+                        - agentWeights(a, path[i - 1], path[i]);
+                    if (delta < expected.Delta)
+                        expected = { delta, i };
+                }
+
+                for (const auto instructionSet : instructionSets)
+                {
+                    CAPTURE(a, first, static_cast<int>(instructionSet));
+                    const auto [delta, position] = tsplp::FindCheapestInsertionPosition(
+                        agentWeights, a, path, first, n, instructionSet);
+                    CHECK(delta == expected.Delta);
+                    CHECK(position == expected.Position);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("cheapest insertion position benchmark", "[.][benchmark][InsertionKernels]")
+{
+    // bundled TSPLIB instances, all long enough to be vectorized
+    const auto instance = GENERATE(as<std::string> {}, "pa561", "rat783", "dsj1000");
+
+    const xt::xtensor<double, 2> weights
+        = xt::load_npy<int>(std::string { TSPLIB_DIR } + "/" + instance + ".tsp.weights.npy");
+    const auto N = weights.shape(0);
+
+    // the nodes in the order of the file, the last one is inserted
+    std::vector<size_t> path(N - 1);
+    std::iota(path.begin(), path.end(), size_t { 0 });
+
+    for (const auto instructionSet : GetTestedInstructionSets())
+    {
+        BENCHMARK(
+            instance + ", instruction set " + std::to_string(static_cast<int>(instructionSet)))
+        {
+            return tsplp::FindCheapestInsertionPosition(
+                weights, 0, path, 1, N - 1, instructionSet);
+        };
+    }
+}
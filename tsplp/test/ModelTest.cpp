@@ -0,0 +1,63 @@
+#include "LinearConstraint.hpp"
+#include "LinearVariableComposition.hpp"
+#include "Model.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <vector>
+
+TEST_CASE("model compaction", "[Model]")
+{
+    using namespace std::chrono_literals;
+
+    tsplp::Model model(4);
+    const auto x = model.GetBinaryVariables();
+
+    const auto objective = 1.0 * x[0] + 2.0 * x[1] + 3.0 * x[2] + 4.0 * x[3] + 10.0;
+    model.SetObjective(objective);
+
+    const std::vector constraints {
+        x[0] + x[1] + x[2] + x[3] == 2, // x[1] + x[2] == 1 once compacted
+        x[0] + x[3] <= 1, // redundant once compacted
+    };
+    model.AddConstraints(constraints.cbegin(), constraints.cend());
+
+    x[0].Fix(1.0, model);
+    x[3].Fix(0.0, model);
+
+    CHECK(model.Compact() == 2);
+
+    // the removed variables keep their values
+    CHECK(x[0].GetLowerBound(model) == 1.0);
+    CHECK(x[0].GetUpperBound(model) == 1.0);
+    CHECK(x[3].GetUpperBound(model) == 0.0);
+
+    REQUIRE(model.Solve(std::chrono::steady_clock::now() + 10s) == tsplp::Status::Optimal);
+    CHECK(x[0].GetObjectiveValue(model) == 1.0);
+    CHECK(x[1].GetObjectiveValue(model) == Approx(1.0));
+    CHECK(x[2].GetObjectiveValue(model) == Approx(0.0).margin(1.e-10));
+    CHECK(objective.Evaluate(model) == Approx(13.0));
+
+    SECTION("constraints may use removed variables")
+    {
+        const std::vector cuts { x[0] + x[2] >= 2 };
+        model.AddConstraints(cuts.cbegin(), cuts.cend());
+
+        REQUIRE(model.Solve(std::chrono::steady_clock::now() + 10s) == tsplp::Status::Optimal);
+        CHECK(x[2].GetObjectiveValue(model) == Approx(1.0));
+        CHECK(objective.Evaluate(model) == Approx(14.0));
+    }
+
+    SECTION("bounds of the remaining variables can be changed")
+    {
+        x[1].Fix(0.0, model);
+
+        REQUIRE(model.Solve(std::chrono::steady_clock::now() + 10s) == tsplp::Status::Optimal);
+        CHECK(x[2].GetObjectiveValue(model) == Approx(1.0));
+
+        x[1].Unfix(model);
+        x[0].Unfix(model);
+        CHECK(x[0].GetLowerBound(model) == 1.0);
+    }
+}
@@ -1,11 +1,19 @@
 #include "MtspModel.hpp"
 
+#include "ConstraintDeque.hpp"
+#include "Status.hpp"
 #include "TsplpExceptions.hpp"
 
 #include <catch2/catch.hpp>
 
+#include <array>
 #include <chrono>
+#include <cmath>
+#include <numeric>
+#include <random>
 #include <thread>
+#include <tuple>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -17,6 +25,22 @@ constexpr auto timeLimit =
 #endif
     ;
 
+namespace tsplp
+{
+struct MtspModelTestAccess
+{
+    // like the first node of branch and cut, without any cuts yet
+    static double DiveFromRoot(MtspModel& model)
+    {
+        model.CreateLinearProgram();
+        REQUIRE(model.m_model.Solve(model.m_endTime) == Status::Optimal);
+
+        ConstraintDeque constraints(1);
+        return model.Dive(model.m_model, constraints);
+    }
+};
+}
+
 TEST_CASE("circular start and end", "[MtspModel]")
 {
     // clang-format off
@@ -67,3 +91,307 @@ TEST_CASE("Timeout", "[MtspModel]")
 
     REQUIRE(result.IsTimeoutHit());
 }
+
+TEST_CASE("symmetric weights", "[MtspModel]")
+{
+    // a 5x5 grid with manhattan distances, where a tour needs one diagonal step because the grid
+    // is bipartite with an odd number of nodes, but a path between opposite corners does not
+    constexpr size_t N = 25;
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+        {
+            const auto dx = static_cast<double>(u % 5) - static_cast<double>(v % 5);
+            const auto dy = static_cast<double>(u / 5) - static_cast<double>(v / 5);
+            weights(u, v) = std::abs(dx) + std::abs(dy);
+        }
+    }
+
+    const auto [end, expectedLength] = GENERATE(std::pair { 0UL, 26.0 }, std::pair { 24UL, 24.0 });
+    xt::xtensor<size_t, 1> startPositions { 0 };
+    xt::xtensor<size_t, 1> endPositions { end };
+
+    tsplp::MtspModel model { startPositions, endPositions, weights, tsplp::OptimizationMode::Sum,
+                             timeLimit };
+    model.BranchAndCutSolve(2);
+    const auto& result = model.GetResult();
+
+    REQUIRE(!result.IsTimeoutHit());
+    REQUIRE(result.GetBounds().Lower == expectedLength);
+    REQUIRE(result.GetBounds().Upper == expectedLength);
+    REQUIRE(result.GetPaths().size() == 1);
+
+    const auto& path = result.GetPaths()[0];
+    REQUIRE(path.size() == (end == 0 ? N + 1 : N));
+    CHECK(path.front() == 0);
+    CHECK(path.back() == end);
+
+    auto length = 0.0;
+    for (size_t i = 1; i < path.size(); ++i)
+        length += weights(path[i - 1], path[i]);
+    CHECK(length == expectedLength);
+}
+
+TEST_CASE("two nodes", "[MtspModel]")
+{
+    // a single edge, whose cycle is the whole tour, and a closed path, whose start and end are
+    // copied to three nodes
+    xt::xtensor<double, 2> weights { { 0, 3 }, { 3, 0 } };
+    const auto [end, expectedPath, expectedLength] = GENERATE(
+        std::tuple { size_t { 1 }, std::vector<size_t> { 0, 1 }, 3.0 },
+        std::tuple { size_t { 0 }, std::vector<size_t> { 0, 1, 0 }, 6.0 });
+    const auto isBoundSolve = GENERATE(false, true);
+    CAPTURE(end, isBoundSolve);
+
+    xt::xtensor<size_t, 1> startPositions { 0 };
+    xt::xtensor<size_t, 1> endPositions { end };
+
+    tsplp::MtspModel model { startPositions, endPositions, weights, tsplp::OptimizationMode::Sum,
+                             timeLimit };
+    if (isBoundSolve)
+        model.BoundSolve(1);
+    else
+        model.BranchAndCutSolve(1, nullptr, false, false);
+    const auto& result = model.GetResult();
+
+    REQUIRE(!result.IsTimeoutHit());
+    CHECK(result.GetBounds().Lower == expectedLength);
+    CHECK(result.GetBounds().Upper == expectedLength);
+    CHECK(result.GetPaths() == std::vector<std::vector<size_t>> { expectedPath });
+}
+
+TEST_CASE("symmetric weights fractional solution", "[MtspModel]")
+{
+    // the grid of "symmetric weights", whose root LP is undirected
+    constexpr size_t N = 25;
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+        {
+            const auto dx = static_cast<double>(u % 5) - static_cast<double>(v % 5);
+            const auto dy = static_cast<double>(u / 5) - static_cast<double>(v / 5);
+            weights(u, v) = std::abs(dx) + std::abs(dy);
+        }
+    }
+
+    xt::xtensor<size_t, 1> startPositions { 0 };
+    xt::xtensor<size_t, 1> endPositions { 24 };
+
+    tsplp::MtspModel model { startPositions, endPositions, weights, tsplp::OptimizationMode::Sum,
+                             timeLimit };
+
+    xt::xtensor<double, 3> fractionalValues;
+    model.BoundSolve(2, [&](const xt::xtensor<double, 3>& values) { fractionalValues = values; });
+
+    // like in the directed formulation, every node is left and entered once, including the
+    // artificial arc, whose value is split as well
+    REQUIRE(fractionalValues.shape() == std::array<size_t, 3> { 1, N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        double outValue = 0.0;
+        double inValue = 0.0;
+        for (size_t v = 0; v < N; ++v)
+        {
+            CHECK(fractionalValues(0, u, v) == fractionalValues(0, v, u));
+            outValue += fractionalValues(0, u, v);
+            inValue += fractionalValues(0, v, u);
+        }
+        CHECK(outValue == Approx(1.0));
+        CHECK(inValue == Approx(1.0));
+    }
+    CHECK(fractionalValues(0, 24, 0) == Approx(0.5));
+}
+
+TEST_CASE("heuristic solve", "[MtspModel]")
+{
+    // the nodes of a regular polygon, so the degree bound equals the optimum
+    constexpr size_t N = 20;
+    constexpr double pi = 3.14159265358979323846;
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+        {
+            const auto angle = 2.0 * pi * static_cast<double>(u + N - v) / static_cast<double>(N);
+            weights(u, v) = std::round(100.0 * std::sqrt(2.0 - 2.0 * std::cos(angle)));
+        }
+    }
+
+    xt::xtensor<size_t, 1> startPositions { 0 };
+    xt::xtensor<size_t, 1> endPositions { 0 };
+
+    tsplp::MtspModel model { startPositions, endPositions, weights, tsplp::OptimizationMode::Sum,
+                             timeLimit };
+    model.HeuristicSolve(2);
+    const auto& result = model.GetResult();
+
+    REQUIRE(!result.IsTimeoutHit());
+    REQUIRE(result.GetBounds().Lower == 20 * weights(0, 1));
+    REQUIRE(result.GetBounds().Upper == 20 * weights(0, 1));
+    REQUIRE(result.GetPaths().size() == 1);
+    REQUIRE(result.GetPaths()[0].size() == N + 1);
+}
+
+TEST_CASE("heuristic solve until timeout", "[MtspModel]")
+{
+    // clang-format off
+    xt::xtensor<int, 2> weights =
+    {
+        {0, 7, 3, 9, 4, 8},
+        {2, 0, 6, 5, 9, 3},
+        {8, 4, 0, 2, 7, 6},
+        {5, 9, 1, 0, 3, 8},
+        {6, 2, 9, 4, 0, 5},
+        {3, 8, 5, 7, 1, 0}
+    };
+    // clang-format on
+
+    xt::xtensor<int, 1> startPositions { 0, 1 };
+    xt::xtensor<int, 1> endPositions { 0, 1 };
+
+    tsplp::MtspModel model { startPositions, endPositions, weights, tsplp::OptimizationMode::Max,
+                             100ms };
+    model.HeuristicSolve(2);
+    const auto& result = model.GetResult();
+
+    const auto [lowerBound, upperBound] = result.GetBounds();
+    REQUIRE(lowerBound > 0);
+    REQUIRE(lowerBound <= upperBound);
+    REQUIRE(result.IsTimeoutHit() == (lowerBound < upperBound));
+
+    const auto& paths = result.GetPaths();
+    REQUIRE(paths.size() == 2);
+    std::vector<size_t> visits(6, 0);
+    for (const auto& path : paths)
+    {
+        for (const auto n : path)
+            ++visits[n];
+    }
+    CHECK(visits == std::vector<size_t> { 2, 2, 1, 1, 1, 1 });
+}
+
+TEST_CASE("dive", "[MtspModel]")
+{
+    // random asymmetric weights, where the root LP is fractional and the initial result is not
+    // optimal
+    constexpr size_t N = 12;
+    std::mt19937_64 generator(N);
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+            weights(u, v) = u == v ? 0.0 : static_cast<double>(generator() % 100 + 1);
+    }
+
+    xt::xtensor<size_t, 1> startPositions { 0 };
+    xt::xtensor<size_t, 1> endPositions { 0 };
+
+    tsplp::MtspModel model { startPositions, endPositions, weights, tsplp::OptimizationMode::Sum,
+                             timeLimit };
+    const auto initialUpperBound = model.GetResult().GetBounds().Upper;
+
+    const auto upperBound = tsplp::MtspModelTestAccess::DiveFromRoot(model);
+    const auto& result = model.GetResult();
+
+    // the dive found the new incumbent, and it is feasible
+    REQUIRE(upperBound < initialUpperBound);
+    CHECK(result.GetBounds().Upper == upperBound);
+
+    const auto& paths = result.GetPaths();
+    REQUIRE(paths.size() == 1);
+    REQUIRE(paths[0].size() == N + 1);
+    CHECK(paths[0].front() == 0);
+    CHECK(paths[0].back() == 0);
+
+    std::vector<size_t> visits(N, 0);
+    double length = 0.0;
+    for (size_t i = 1; i < paths[0].size(); ++i)
+    {
+        length += weights(paths[0][i - 1], paths[0][i]);
+        ++visits[paths[0][i]];
+    }
+
+    CHECK(length == upperBound);
+    for (size_t n = 0; n < N; ++n)
+        CHECK(visits[n] == 1);
+}
+
+TEST_CASE("decomposition solve", "[MtspModel]")
+{
+    // nodes on a line with the depot 0 in the middle, so each agent serves one side, which is
+    // longer than a window of OptimizeWindows for the larger instance
+    const auto half = GENERATE(size_t { 10 }, tsplp::DefaultWindowSize + 10);
+    const auto N = 2 * half + 1;
+    const auto position = [&](size_t n)
+    {
+        const auto x = static_cast<double>(n);
+        return n <= half ? x : static_cast<double>(half) - x;
+    };
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+            weights(u, v) = std::abs(position(u) - position(v));
+    }
+
+    xt::xtensor<size_t, 1> startPositions { 0, 0 };
+    xt::xtensor<size_t, 1> endPositions { 0, 0 };
+
+    const auto mode = GENERATE(tsplp::OptimizationMode::Sum, tsplp::OptimizationMode::Max);
+    tsplp::MtspModel model { startPositions, endPositions, weights, mode, timeLimit };
+    model.DecompositionSolve(2);
+    const auto& result = model.GetResult();
+
+    const auto length = static_cast<double>(2 * half);
+    CHECK(result.GetBounds().Upper == (mode == tsplp::OptimizationMode::Sum ? 2 * length : length));
+    CHECK(result.GetBounds().Lower <= result.GetBounds().Upper);
+
+    const auto& paths = result.GetPaths();
+    REQUIRE(paths.size() == 2);
+    std::vector<size_t> visits(N, 0);
+    for (const auto& path : paths)
+    {
+        REQUIRE(path.size() >= 2);
+        CHECK(path.front() == 0);
+        CHECK(path.back() == 0);
+        for (size_t i = 1; i + 1 < path.size(); ++i)
+            ++visits[path[i]];
+    }
+
+    for (size_t n = 1; n < N; ++n)
+        CHECK(visits[n] == 1);
+}
+
+TEST_CASE("optimize windows", "[MtspModel]")
+{
+    // nodes on a line, so the sorted order is optimal
+    constexpr size_t N = 30;
+    auto weights = xt::xtensor<double, 2>::from_shape({ N, N });
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+            weights(u, v) = std::abs(static_cast<double>(u) - static_cast<double>(v));
+    }
+
+    // neighbors are swapped, also across the borders of the windows
+    std::vector<size_t> path { 0 };
+    for (size_t n = 1; n + 2 < N; n += 2)
+    {
+        path.push_back(n + 1);
+        path.push_back(n);
+    }
+    path.push_back(N - 1);
+
+    const auto mode = GENERATE(tsplp::OptimizationMode::Sum, tsplp::OptimizationMode::Max);
+    const auto [paths, objective] = tsplp::OptimizeWindows(
+        mode, { path }, weights, std::chrono::steady_clock::now() + timeLimit, 8, 2);
+
+    REQUIRE(paths.size() == 1);
+    CHECK(objective == static_cast<double>(N - 1));
+
+    std::vector<size_t> expectedPath(N);
+    std::iota(expectedPath.begin(), expectedPath.end(), 0);
+    CHECK(paths[0] == expectedPath);
+}
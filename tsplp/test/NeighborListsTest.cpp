@@ -0,0 +1,85 @@
+#include "NeighborLists.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+TEST_CASE("neighbor lists", "[NeighborLists]")
+{
+    // 1 -> 3
+    // clang-format off
+    const xt::xtensor<double, 2> weights =
+    {
+        { 0, 2, 3, 4 },
+        { 2, 0, 6, 8 },
+        { 4, 5, 0, 7 },
+        { 0,-1, 2, 0 }
+    };
+    // clang-format on
+
+    const tsplp::NeighborLists neighborLists { weights, 2 };
+
+    const auto asVector = [](std::span<const size_t> span)
+    { return std::vector(span.begin(), span.end()); };
+
+    CHECK(asVector(neighborLists.GetOutgoingSpan(0)) == std::vector<size_t> { 1, 2 });
+    CHECK(asVector(neighborLists.GetOutgoingSpan(1)) == std::vector<size_t> { 0, 2 });
+    CHECK(asVector(neighborLists.GetOutgoingSpan(2)) == std::vector<size_t> { 0, 1 });
+    CHECK(asVector(neighborLists.GetOutgoingSpan(3)) == std::vector<size_t> { 0, 2 });
+
+    CHECK(asVector(neighborLists.GetIncomingSpan(0)) == std::vector<size_t> { 3, 1 });
+    CHECK(asVector(neighborLists.GetIncomingSpan(1)) == std::vector<size_t> { 0, 2 });
+    CHECK(asVector(neighborLists.GetIncomingSpan(2)) == std::vector<size_t> { 3, 0 });
+    CHECK(asVector(neighborLists.GetIncomingSpan(3)) == std::vector<size_t> { 0, 2 });
+}
+
+TEST_CASE("neighbor lists alpha-nearness", "[NeighborLists]")
+{
+    // the minimum spanning tree is 0 - 1 - 2 - 3
+    // clang-format off
+    const xt::xtensor<double, 2> weights =
+    {
+        { 0,   1, 3, 4.5 },
+        { 1,   0, 1, 5   },
+        { 3,   1, 0, 4   },
+        { 4.5, 5, 4, 0   }
+    };
+    // clang-format on
+
+    const auto asVector = [](std::span<const size_t> span)
+    { return std::vector(span.begin(), span.end()); };
+
+    const tsplp::NeighborLists byWeight { weights, 3 };
+    CHECK(asVector(byWeight.GetOutgoingSpan(0)) == std::vector<size_t> { 1, 2, 3 });
+
+    // alpha(0, 2) = 3 - 1, alpha(0, 3) = 4.5 - 4
+    const tsplp::NeighborLists byAlpha { weights, 3, tsplp::NeighborLists::Measure::AlphaNearness };
+    CHECK(asVector(byAlpha.GetOutgoingSpan(0)) == std::vector<size_t> { 1, 3, 2 });
+    CHECK(asVector(byAlpha.GetIncomingSpan(0)) == std::vector<size_t> { 1, 3, 2 });
+    CHECK(asVector(byAlpha.GetOutgoingSpan(3)) == std::vector<size_t> { 2, 0, 1 });
+}
+
+TEST_CASE("neighbor lists parallel", "[NeighborLists]")
+{
+    constexpr size_t N = 1000;
+    xt::xtensor<double, 2> weights({ N, N }, 0.0);
+    for (size_t u = 0; u < N; ++u)
+    {
+        for (size_t v = 0; v < N; ++v)
+            weights(u, v) = static_cast<double>((u * 37 + v * 91) % 101);
+    }
+
+    for (const auto measure :
+         { tsplp::NeighborLists::Measure::Weight, tsplp::NeighborLists::Measure::AlphaNearness })
+    {
+        const tsplp::NeighborLists sequential { weights, 5, measure, 1 };
+        const tsplp::NeighborLists parallel { weights, 5, measure, 4 };
+
+        for (size_t n = 0; n < N; ++n)
+        {
+            REQUIRE(std::ranges::equal(sequential.GetOutgoingSpan(n), parallel.GetOutgoingSpan(n)));
+            REQUIRE(std::ranges::equal(sequential.GetIncomingSpan(n), parallel.GetIncomingSpan(n)));
+        }
+    }
+}
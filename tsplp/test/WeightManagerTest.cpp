@@ -352,3 +352,16 @@ TEST_CASE("Set diagonal to 0", "[WeightManager]")
 
     REQUIRE(wm.W() == expectedWeights);
 }
+
+TEST_CASE("Agent classes", "[WeightManager]")
+{
+    const xt::xtensor<int, 2> weights = { { 0, 1, 2 }, { 3, 0, 4 }, { 5, 6, 0 } };
+
+    const xt::xtensor<size_t, 1> sp = { 0, 1, 0, 0, 1, 2 };
+    const xt::xtensor<size_t, 1> ep = { 0, 2, 0, 1, 2, 2 };
+
+    const tsplp::WeightManager wm { weights, sp, ep };
+
+    // agents 3 and 5 are distinct from all others
+    REQUIRE(wm.AgentClasses() == std::vector { std::vector<size_t> { 0, 2 }, { 1, 4 } });
+}
@@ -41,12 +41,16 @@ TEST_CASE("br17.atsp", "[instances]")
     xt::xtensor<int, 1> startPositions { 0 };
     xt::xtensor<int, 1> endPositions { 0 };
 
+    // the LP is skipped for instances this small unless Held-Karp is disallowed
+    const auto allowHeldKarp = GENERATE(false, true);
+    CAPTURE(allowHeldKarp);
+
     const auto startTime = std::chrono::steady_clock::now();
 
     tsplp::MtspModel model { startPositions, endPositions,
                              weights,        tsplp::OptimizationMode::Sum,
                              timeLimit,      Catch::getResultCapture().getCurrentTestName() };
-    model.BranchAndCutSolve();
+    model.BranchAndCutSolve(std::nullopt, nullptr, false, allowHeldKarp);
     const auto& result = model.GetResult();
 
     const auto endTime = std::chrono::steady_clock::now();
@@ -57,6 +61,58 @@ TEST_CASE("br17.atsp", "[instances]")
     CHECK(result.GetBounds().Upper == Approx(39));
 }
 
+TEST_CASE("br17.atsp bound", "[instances]")
+{
+    // clang-format off
+    xt::xtensor<int, 2> weights =
+    {
+        {9999, 3, 5, 48, 48, 8, 8, 5, 5, 3, 3, 0, 3, 5, 8, 8, 5},
+        {3, 9999, 3, 48, 48, 8, 8, 5, 5, 0, 0, 3, 0, 3, 8, 8, 5},
+        {5, 3, 9999, 72, 72, 48, 48, 24, 24, 3, 3, 5, 3, 0, 48, 48, 24},
+        {48,48, 74, 9999, 0, 6, 6, 12, 12, 48, 48, 48, 48, 74, 6, 6, 12},
+        {48,48, 74, 0, 9999, 6, 6, 12, 12, 48, 48, 48, 48, 74, 6, 6, 12},
+        {8, 8, 50, 6, 6, 9999, 0, 8, 8, 8, 8, 8, 8, 50, 0, 0, 8},
+        {8, 8, 50, 6, 6, 0, 9999, 8, 8, 8, 8, 8, 8, 50, 0, 0, 8},
+        {5, 5, 26, 12, 12, 8, 8, 9999, 0, 5, 5, 5, 5, 26, 8, 8, 0},
+        {5, 5, 26, 12, 12, 8, 8, 0, 9999, 5, 5, 5, 5, 26, 8, 8, 0},
+        {3, 0, 3, 48, 48, 8, 8, 5, 5, 9999, 0, 3, 0, 3, 8, 8, 5},
+        {3, 0, 3, 48, 48, 8, 8, 5, 5, 0, 9999, 3, 0, 3, 8, 8, 5},
+        {0, 3, 5, 48, 48, 8, 8, 5, 5, 3, 3, 9999, 3, 5, 8, 8, 5},
+        {3, 0, 3, 48, 48, 8, 8, 5, 5, 0, 0, 3, 9999, 3, 8, 8, 5},
+        {5, 3, 0, 72, 72, 48, 48, 24, 24, 3, 3, 5, 3, 9999, 48, 48, 24},
+        {8, 8, 50, 6, 6, 0, 0, 8, 8, 8, 8, 8, 8, 50, 9999, 0, 8},
+        {8, 8, 50, 6, 6, 0, 0, 8, 8, 8, 8, 8, 8, 50, 0, 9999, 8},
+        {5, 5, 26, 12, 12, 8, 8, 0, 0, 5, 5, 5, 5, 26, 8, 8, 9999}
+    };
+    // clang-format on
+
+    xt::xtensor<int, 1> startPositions { 0 };
+    xt::xtensor<int, 1> endPositions { 0 };
+
+    tsplp::MtspModel model { startPositions, endPositions,
+                             weights,        tsplp::OptimizationMode::Sum,
+                             timeLimit,      Catch::getResultCapture().getCurrentTestName() };
+
+    xt::xtensor<double, 3> fractionalValues;
+    model.BoundSolve(
+        std::nullopt, [&](const xt::xtensor<double, 3>& values) { fractionalValues = values; });
+    const auto& result = model.GetResult();
+
+    CHECK(!result.IsTimeoutHit());
+    CHECK(result.GetBounds().Lower > 0);
+    CHECK(result.GetBounds().Lower <= 39);
+
+    // every node is entered once in the original numbering, except the start, which has a copy
+    REQUIRE(fractionalValues.shape() == std::array<size_t, 3> { 1, 17, 17 });
+    for (size_t v = 1; v < 17; ++v)
+    {
+        double incoming = 0.0;
+        for (size_t u = 0; u < 17; ++u)
+            incoming += fractionalValues(0, u, v);
+        CHECK(incoming == Approx(1.0));
+    }
+}
+
 TEST_CASE("br17.atsp 4 agents vrp", "[instances]")
 {
     // clang-format off
@@ -85,12 +141,15 @@ TEST_CASE("br17.atsp 4 agents vrp", "[instances]")
     xt::xtensor<int, 1> startPositions { 0, 0, 0, 0 };
     xt::xtensor<int, 1> endPositions { 0, 0, 0, 0 };
 
+    const auto backgroundHeuristic = GENERATE(false, true);
+    CAPTURE(backgroundHeuristic);
+
     const auto startTime = std::chrono::steady_clock::now();
 
     tsplp::MtspModel model { startPositions, endPositions,
                              weights,        tsplp::OptimizationMode::Sum,
                              timeLimit,      Catch::getResultCapture().getCurrentTestName() };
-    model.BranchAndCutSolve();
+    model.BranchAndCutSolve(std::nullopt, nullptr, backgroundHeuristic);
     const auto& result = model.GetResult();
 
     const auto endTime = std::chrono::steady_clock::now();
@@ -133,7 +192,8 @@ TEST_CASE("ESC07.sop", "[instances]")
             timeLimit,
             Catch::getResultCapture().getCurrentTestName() + std::to_string(iteration)
         };
-        model.BranchAndCutSolve();
+        // without Held-Karp, which would solve it before the LP is even created
+        model.BranchAndCutSolve(std::nullopt, nullptr, false, false);
         const auto& result = model.GetResult();
 
         const auto endTime = std::chrono::steady_clock::now();
@@ -176,7 +236,8 @@ TEST_CASE("ESC07.sop start end same", "[instances]")
             timeLimit,
             Catch::getResultCapture().getCurrentTestName() + std::to_string(iteration)
         };
-        model.BranchAndCutSolve();
+        // without Held-Karp, which would solve it before the LP is even created
+        model.BranchAndCutSolve(std::nullopt, nullptr, false, false);
         const auto& result = model.GetResult();
 
         const auto endTime = std::chrono::steady_clock::now();